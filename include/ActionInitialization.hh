@@ -5,17 +5,31 @@
 #define TOYLARTPC_ACTIONINITIALIZATION_HH
 
 #include "G4VUserActionInitialization.hh"
+#include "globals.hh"
 
 namespace ToyLArTPC {
 
+/// Optical-photon decimation used in interactive mode, so that full-yield
+/// events stay drawable.
+struct VisOptions {
+    G4bool enabled       = false;  ///< Install the decimating TrackingAction
+    G4int  photonStride  = 1;      ///< Keep 1 in N optical-photon trajectories
+    G4int  maxPhotons    = 0;      ///< Photon trajectories kept per event (0 = all)
+    G4bool detectedOnly  = false;  ///< Keep only photons that reached a tile
+};
+
 /// Sets up the user action classes (PrimaryGenerator, etc.).
 class ActionInitialization : public G4VUserActionInitialization
 {
 public:
-    ActionInitialization() = default;
+    explicit ActionInitialization(const VisOptions& vis = VisOptions())
+        : fVis(vis) {}
     ~ActionInitialization() override = default;
 
     void Build() const override;
+
+private:
+    VisOptions fVis;
 };
 
 } // namespace ToyLArTPC
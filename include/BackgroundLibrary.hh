@@ -0,0 +1,90 @@
+/// \file BackgroundLibrary.hh
+/// \brief Definition of the ToyLArTPC::BackgroundLibrary class.
+
+#ifndef TOYLARTPC_BACKGROUNDLIBRARY_HH
+#define TOYLARTPC_BACKGROUNDLIBRARY_HH
+
+#include "PhotonHit.hh"
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Library of pre-simulated Ar-39 decays, overlaid on signal events.
+///
+/// Recording: with the generator in Ar-39 mode, each event is one decay
+/// at t = 0 and its detected photons are appended to the library.
+///
+/// Overlay: for a signal event starting at t0, decays are drawn at the
+/// configured rate uniformly in [t0 - tail, t0 + window), where `tail` is
+/// the latest photon time in the library, so late light from earlier
+/// decays is included.  Each decay picks a random library entry; photons
+/// arriving inside the readout window [t0, t0 + window) are added to the
+/// tile counts.  Decays whose light falls entirely inside the window are
+/// added from a dense per-entry count row.
+///
+/// File: 8-byte magic "TLTAR39L", uint32 version, uint32 number of tiles,
+/// uint64 number of entries, then per entry uint32 number of hits followed
+/// by {float time [ns], int32 tile} per hit, all little-endian.
+class BackgroundLibrary
+{
+public:
+    /// Ar-39 activity of the full TPC [Hz]: 1.01 Bq/kg of atmospheric argon.
+    static G4double GetDefaultRate();
+
+    // --- Recording (library production run) ---
+
+    /// Open a new library for writing (master thread, before BeamOn).
+    static void StartRecording(const std::string& file);
+
+    static G4bool IsRecording() { return fgOutput != nullptr; }
+
+    /// Append the hits of one decay; times are taken relative to `t0`.
+    static void Record(const PhotonHitsCollection& hits, G4double t0);
+
+    /// Patch the entry count and close the library (master thread).
+    static void FinishRecording();
+
+    // --- Overlay ---
+
+    /// Read a library into memory (master thread, before the workers start).
+    static void Load(const std::string& file);
+
+    static G4bool IsLoaded() { return !fgOffsets.empty(); }
+
+    /// Decay rate in the TPC [Hz] and readout window (internal time units).
+    static void SetRate(G4double rateHz)      { fgRate = rateHz; }
+    static void SetReadoutWindow(G4double w)  { fgWindow = w; }
+
+    /// Add the background light of one readout window starting at `t0`
+    /// to `counts` (one entry per tile).  Returns the number of decays drawn.
+    static G4int Overlay(G4double t0, std::vector<G4int>& counts);
+
+private:
+    // Recording
+    static std::FILE*    fgOutput;
+    static std::uint64_t fgRecorded;
+    static std::mutex    fgMutex;
+
+    // Loaded library, structure-of-arrays: hits of entry i are
+    // [fgOffsets[i], fgOffsets[i + 1]) in fgHitTimes / fgHitTiles.
+    static std::vector<std::uint64_t> fgOffsets;
+    static std::vector<G4float>       fgHitTimes;
+    static std::vector<G4int>         fgHitTiles;
+    static std::vector<G4int>         fgDenseCounts;   ///< nEntries × nTiles
+    static std::vector<G4float>       fgLastTime;      ///< Latest hit per entry
+    static G4double                   fgTail;          ///< Latest hit overall
+
+    static G4double fgRate;     ///< Decays per second in the TPC
+    static G4double fgWindow;   ///< Readout window length
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_BACKGROUNDLIBRARY_HH
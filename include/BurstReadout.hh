@@ -0,0 +1,99 @@
+/// \file BurstReadout.hh
+/// \brief Definition of the ToyLArTPC::BurstReadout class.
+
+#ifndef TOYLARTPC_BURSTREADOUT_HH
+#define TOYLARTPC_BURSTREADOUT_HH
+
+#include "globals.hh"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Supernova-burst streaming mode.
+///
+/// Each Geant4 event of the run is one interaction of the burst.  Before
+/// the run, interaction times are drawn from a luminosity profile and
+/// sorted, so event i happens at the i-th time.  Workers submit the
+/// time-sorted photon hits of each finished event; these runs are k-way
+/// merged into one globally time-ordered stream of (time, tile, event)
+/// records.  A hit is written once no unfinished event can still produce
+/// an earlier one, i.e. once its time is below the start time of the
+/// lowest unfinished event.  Workers may run at most `window` events ahead
+/// of that event, which bounds the memory held in the merge.
+///
+/// Output: 8-byte magic "TLTBURST", uint32 version, uint32 number of tiles,
+/// uint64 number of records, then records of {double time [ns],
+/// int32 tile, int32 event ID}, all little-endian.
+class BurstReadout
+{
+public:
+    /// One detected photon in the readout stream.
+    struct Record {
+        G4double time;   ///< Global time [ns] since the start of the burst
+        G4int    tile;
+        G4int    eventID;
+    };
+
+    /// Enable burst mode (master thread, before the run).
+    /// @param profileFile  Two columns "time[s] relative-rate"; empty for
+    ///                     the built-in rise/exponential-cooling profile.
+    static void Configure(const std::string& outputFile, G4double duration,
+                          const std::string& profileFile, G4int window);
+
+    static G4bool IsEnabled() { return !fgOutputFile.empty(); }
+
+    /// Draw and sort the interaction times of `nEvents` events and open the
+    /// output (master thread, before BeamOn).
+    static void Start(G4int nEvents);
+
+    /// Interaction time [ns] of `eventID` in the current run.
+    static G4double GetInteractionTime(G4int eventID);
+
+    /// Block until `eventID` is within the reorder window.
+    static void WaitForWindow(G4int eventID);
+
+    /// Hand over the hits of a finished event (any order; emptied on return).
+    static void Submit(G4int eventID, std::vector<Record>& hits);
+
+    /// Write everything still buffered and close the output (master thread,
+    /// after BeamOn).
+    static void Finish();
+
+private:
+    /// Sorted hits of one finished event and the next one to emit.
+    struct Run {
+        std::vector<Record> hits;
+        std::size_t         next = 0;
+    };
+
+    static std::vector<G4double> SampleTimes(G4int nEvents);
+    static void Drain(G4double watermark);   ///< requires fgMutex
+
+    static std::string fgOutputFile;
+    static std::string fgProfileFile;
+    static G4double    fgDuration;
+    static G4int       fgWindow;
+
+    static std::vector<G4double> fgTimes;     ///< Interaction time per event ID
+    static std::vector<char>     fgFinished;  ///< Per event ID
+    static G4int                 fgLowestUnfinished;
+
+    static std::mutex              fgMutex;
+    static std::condition_variable fgWindowMoved;
+    static std::map<G4int, Run>    fgRuns;    ///< Finished, not fully emitted
+    static std::vector<std::pair<G4double, G4int>> fgHeads;  ///< Min-heap of (next time, event)
+    static std::FILE*              fgFile;
+    static std::uint64_t           fgRecords;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_BURSTREADOUT_HH
@@ -0,0 +1,92 @@
+/// \file ChargeReadout.hh
+/// \brief Definition of the ToyLArTPC::ChargeReadout class and the
+///        ChargeClusters and ChargeImage containers.
+
+#ifndef TOYLARTPC_CHARGEREADOUT_HH
+#define TOYLARTPC_CHARGEREADOUT_HH
+
+#include "DetectorParameters.hh"
+
+#include "globals.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Ionization electrons of one event after recombination, one cluster per
+/// charged-particle step, stored as structure of arrays.
+struct ChargeClusters {
+    std::vector<G4float> x, y, z;    ///< Step midpoint [mm]
+    std::vector<G4float> t;          ///< Global time [ns]
+    std::vector<G4float> electrons;
+
+    std::size_t size() const { return electrons.size(); }
+
+    void clear()
+    {
+        x.clear(); y.clear(); z.clear(); t.clear(); electrons.clear();
+    }
+
+    void push_back(G4float cx, G4float cy, G4float cz, G4float ct, G4float ne)
+    {
+        x.push_back(cx); y.push_back(cy); z.push_back(cz);
+        t.push_back(ct); electrons.push_back(ne);
+    }
+};
+
+/// Zero-suppressed charge image of one event: one entry per
+/// (anode plane, channel, tick) above threshold.  Bound to the vector
+/// columns of the ChargeHits ntuple.
+struct ChargeImage {
+    std::vector<G4int>   plane;     ///< 0: anode at -x, 1: anode at +x
+    std::vector<G4int>   channel;   ///< Pixel iy * nZ + iz, or wire iz
+    std::vector<G4int>   tick;      ///< Arrival tick after the interaction
+    std::vector<G4float> charge;    ///< Electrons
+
+    void clear() { plane.clear(); channel.clear(); tick.clear(); charge.clear(); }
+};
+
+/// Readout configuration.
+struct ChargeSettings {
+    G4bool   wires     = false;    ///< Collection wires along y instead of pixels
+    G4double pitch     = 4.;       ///< Pixel / wire pitch [mm]
+    G4double tick      = 500.;     ///< Sampling period [ns]
+    G4double lifetime  = DetectorParameters::kElectronLifetime;   ///< Electron lifetime [ns]
+    G4double threshold = 100.;     ///< Zero suppression [electrons]
+};
+
+/// Drifts ionization clusters to the anode planes at x = ±1 m and projects
+/// them onto the pixel (or wire) and time grid.
+///
+/// Each cluster drifts along x to the nearer anode; it loses electrons to
+/// attachment with the electron lifetime and spreads by longitudinal and
+/// transverse diffusion.  Its expected charge is then shared among the
+/// cells within 3 sigma by integrating the Gaussian over every cell (erf
+/// differences).  Both steps run over a whole event at a time on
+/// structure-of-arrays data, in loops written for vectorization, with the
+/// per-thread scratch arrays reused from event to event.  Charge is the
+/// expectation per cell; fluctuations are not simulated.
+class ChargeReadout
+{
+public:
+    /// Enable the readout (master thread, before the run).
+    static void Configure(const ChargeSettings& settings);
+    static G4bool IsEnabled() { return fgEnabled; }
+    static const ChargeSettings& GetSettings() { return fgSettings; }
+
+    /// Channels per anode plane.
+    static G4int GetNumberOfChannels();
+
+    /// Drift `clusters` of an interaction at time `t0` and write the
+    /// zero-suppressed image to `image`.
+    static void Process(const ChargeClusters& clusters, G4double t0, ChargeImage& image);
+
+private:
+    static G4bool         fgEnabled;
+    static ChargeSettings fgSettings;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_CHARGEREADOUT_HH
@@ -0,0 +1,50 @@
+/// \file ChargeSD.hh
+/// \brief Definition of the ToyLArTPC::ChargeSD class.
+
+#ifndef TOYLARTPC_CHARGESD_HH
+#define TOYLARTPC_CHARGESD_HH
+
+#include "ChargeReadout.hh"
+
+#include "G4VSensitiveDetector.hh"
+
+namespace ToyLArTPC {
+
+/// Sensitive detector attached to the TPC volume when IsNeeded(): it is
+/// called on every step there, optical photons included.
+/// Sums the energy deposited in the event (for the truth record) and, with
+/// the charge readout enabled, turns the ionizing energy of every
+/// charged-particle step into a cluster of drift electrons, after
+/// Box-model recombination at the step's dE/dx.  The clusters of an event
+/// are read out by ChargeReadout from EventAction.
+class ChargeSD : public G4VSensitiveDetector
+{
+public:
+    /// Record the energy deposit in the Truth ntuple even without the
+    /// charge readout (before the geometry is built).
+    static void   SetEnergyDepositTruth(G4bool on) { fgEnergyDepositTruth = on; }
+    /// Attach the detector: charge readout or energy-deposit truth wanted.
+    static G4bool IsNeeded() { return fgEnergyDepositTruth || ChargeReadout::IsEnabled(); }
+
+    explicit ChargeSD(const G4String& name);
+    ~ChargeSD() override = default;
+
+    void   Initialize(G4HCofThisEvent* hce) override;
+    G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+
+    /// Clusters collected in the current event.
+    const ChargeClusters& GetClusters() const { return fClusters; }
+
+    /// Energy deposited in the TPC in the current event.
+    G4double GetEnergyDeposit() const { return fEnergyDeposit; }
+
+private:
+    ChargeClusters fClusters;
+    G4double       fEnergyDeposit = 0.;
+
+    static G4bool fgEnergyDepositTruth;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_CHARGESD_HH
@@ -0,0 +1,72 @@
+/// \file Checkpoint.hh
+/// \brief Definition of the ToyLArTPC::Checkpoint class.
+
+#ifndef TOYLARTPC_CHECKPOINT_HH
+#define TOYLARTPC_CHECKPOINT_HH
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Contents of a checkpoint file.
+struct CheckpointRecord {
+    G4int total     = 0;    ///< Events requested by the original job
+    G4int completed = 0;    ///< Events safely flushed, over all segments
+    G4int cursor    = 0;    ///< Next index into the MARLEY event cache
+    G4int segment   = 0;    ///< Output segment being written (0 = first)
+    std::string output;     ///< Base name of the job's output files
+    std::uint64_t seed = 1; ///< RandomStreams seed of the job
+    std::vector<unsigned long> masterRandomState;  ///< Engine state at segment start
+
+    /// Per-thread progress at the last flush.
+    struct ThreadState {
+        G4int flushed     = 0;    ///< Events flushed to this thread's file
+        G4int lastEventID = -1;   ///< Last event included in the flush
+        std::vector<unsigned long> randomState;   ///< Engine state after it
+    };
+    std::map<G4int, ThreadState> threads;   ///< keyed by Geant4 thread ID
+};
+
+/// Periodic flush bookkeeping for long batch runs.
+///
+/// Every worker flushes its output file after each `interval` completed
+/// events and then reports here; the checkpoint file is rewritten (via a
+/// temporary file and rename) after every report, so it never describes
+/// events that are not on disk.  A killed job can be resumed from it with
+/// `-resume`, which writes the remaining events to a new output segment.
+class Checkpoint
+{
+public:
+    /// Enable checkpointing for the coming run (master thread only).
+    static void Start(const std::string& path, G4int interval,
+                      const CheckpointRecord& base);
+
+    static bool  IsEnabled()   { return fgInterval > 0; }
+    static G4int GetInterval() { return fgInterval; }
+
+    /// Report that `threadID` has flushed `flushed` events so far in this
+    /// segment, the last one being `lastEventID`.  Thread-safe.
+    static void RecordFlush(G4int threadID, G4int flushed, G4int lastEventID);
+
+    /// Read a checkpoint file; returns false if it cannot be parsed.
+    static bool Read(const std::string& path, CheckpointRecord& record);
+
+private:
+    static void Write(const CheckpointRecord& record);
+
+    static std::mutex       fgMutex;
+    static std::string      fgPath;
+    static G4int            fgInterval;
+    static CheckpointRecord fgBase;      ///< Totals of the previous segments
+    static CheckpointRecord fgCurrent;   ///< Progress of this segment
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_CHECKPOINT_HH
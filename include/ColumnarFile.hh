@@ -0,0 +1,348 @@
+/// \file ColumnarFile.hh
+/// \brief Definition of the native columnar output format and of the
+///        ToyLArTPC::ColumnarFile reader.
+///
+/// Kept free of Geant4 dependencies so that standalone consumers can read
+/// the files; the simulation writes them through NativeOutputSink.
+
+#ifndef TOYLARTPC_COLUMNARFILE_HH
+#define TOYLARTPC_COLUMNARFILE_HH
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef TOYLARTPC_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ToyLArTPC {
+
+/// On-disk layout of the native output (".tlc"), all little-endian.
+///
+///   header   "TLTCOLS1", u32 version, u32 flags, u64 footer offset,
+///            u64 footer size
+///   blocks   column data, each block starting on an 8-byte boundary
+///   footer   u64 previous footer offset, u64 previous footer size (0 for
+///            none), u32 nTables, then per table: name, title (u32 length
+///            and bytes), u32 nColumns, per column name, u8 type, u8 vector;
+///            u32 nChunks, per chunk u64 nRows and the column blocks; u32
+///            nKept, u32 nTail and as many tail chunks, in the same form
+///
+/// A scalar column has one block per chunk holding nRows fixed-width
+/// values.  A vector column has two: nRows u64 end offsets into the
+/// chunk's values, then the values.  Uncompressed blocks can be used in
+/// place from a memory map; compressed ones are one zstd frame each.
+///
+/// The header points at the newest footer.  A footer written by a flush
+/// lists only what was written since the previous footer, which it points
+/// back to: the chunks completed since, and the rows flushed from the still
+/// open chunk as tail chunks.  Of the tail chunks listed before, it keeps
+/// the first nKept (all, unless the open chunk was completed and written
+/// whole).  The chunks of a table are those of the chain, oldest first,
+/// then the tail left by the newest footer.  Closing the file writes one
+/// footer listing every chunk.  Footers are appended and the header is
+/// updated last, so a file cut short by a killed job still reads up to its
+/// last flush.
+namespace Columnar {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "the native format is read and written in host byte order");
+
+constexpr char          kMagic[8] = { 'T', 'L', 'T', 'C', 'O', 'L', 'S', '1' };
+constexpr std::uint32_t kVersion  = 2;
+
+/// Size of the header; the footer offset and size are at bytes 16 and 24.
+constexpr std::size_t kHeaderSize = 32;
+
+/// Column value types.
+enum Type : std::uint8_t { kInt32 = 0, kFloat32 = 1, kFloat64 = 2 };
+
+inline std::size_t TypeSize(std::uint8_t type) { return type == kFloat64 ? 8 : 4; }
+
+/// Block compression.
+enum Codec : std::uint32_t { kRaw = 0, kZstd = 1 };
+
+/// Location of one block in the file.
+struct Block {
+    std::uint64_t offset     = 0;
+    std::uint64_t storedSize = 0;   ///< Bytes in the file
+    std::uint64_t rawSize    = 0;   ///< Bytes after decompression
+    std::uint32_t codec      = kRaw;
+    std::uint32_t reserved   = 0;
+};
+
+} // namespace Columnar
+
+/// Read-only view of a native output file through a memory map.
+class ColumnarFile
+{
+public:
+    struct Column {
+        std::string  name;
+        std::uint8_t type   = Columnar::kInt32;
+        bool         vector = false;
+    };
+
+    struct Chunk {
+        std::uint64_t                rows = 0;
+        std::vector<Columnar::Block> blocks;   ///< Per column, two for vectors
+    };
+
+    struct Table {
+        std::string         name, title;
+        std::vector<Column> columns;
+        std::vector<Chunk>  chunks;
+        std::vector<std::size_t> firstBlock;   ///< Per column, into Chunk::blocks
+
+        std::uint64_t GetNumberOfRows() const
+        {
+            std::uint64_t rows = 0;
+            for (const auto& chunk : chunks) rows += chunk.rows;
+            return rows;
+        }
+
+        /// Column index of `column`, -1 if absent.
+        int Find(const std::string& column) const
+        {
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                if (columns[c].name == column) return static_cast<int>(c);
+            }
+            return -1;
+        }
+    };
+
+    /// Map `path` and read its footer.
+    explicit ColumnarFile(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("ColumnarFile: cannot open " + path);
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            fSize = static_cast<std::size_t>(st.st_size);
+            void* map = ::mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            fData = (map == MAP_FAILED) ? nullptr : static_cast<const char*>(map);
+        }
+        ::close(fd);
+        if (!fData || !ReadFooter()) {
+            Unmap();
+            throw std::runtime_error("ColumnarFile: " + path + " is not a native output file");
+        }
+    }
+
+    ~ColumnarFile() { Unmap(); }
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    const std::vector<Table>& GetTables() const { return fTables; }
+
+    /// Table `name`; throws if absent.
+    const Table& GetTable(const std::string& name) const
+    {
+        for (const auto& table : fTables) {
+            if (table.name == name) return table;
+        }
+        throw std::runtime_error("ColumnarFile: no table " + name);
+    }
+
+    /// Values of column `column` in chunk `chunk` (for a vector column, the
+    /// concatenated values of all rows).  Points into the map if the block
+    /// is stored raw, otherwise into `scratch`, which it decompresses to.
+    template <typename T>
+    const T* GetValues(const Table& table, std::size_t column, std::size_t chunk,
+                       std::vector<char>& scratch, std::uint64_t& count) const
+    {
+        const auto& col = table.columns.at(column);
+        const auto& block = table.chunks.at(chunk).blocks[table.firstBlock[column]
+                                                          + (col.vector ? 1 : 0)];
+        if (sizeof(T) != Columnar::TypeSize(col.type)) {
+            throw std::runtime_error("ColumnarFile: wrong type for column " + col.name);
+        }
+        count = block.rawSize / sizeof(T);
+        return reinterpret_cast<const T*>(Load(block, scratch));
+    }
+
+    /// Row end offsets of vector column `column` in chunk `chunk`: row r
+    /// holds values [r ? ends[r - 1] : 0, ends[r]).
+    const std::uint64_t* GetEnds(const Table& table, std::size_t column, std::size_t chunk,
+                                 std::vector<char>& scratch) const
+    {
+        if (!table.columns.at(column).vector) {
+            throw std::runtime_error("ColumnarFile: " + table.columns[column].name
+                                     + " is not a vector column");
+        }
+        const auto& block = table.chunks.at(chunk).blocks[table.firstBlock[column]];
+        return reinterpret_cast<const std::uint64_t*>(Load(block, scratch));
+    }
+
+private:
+    const char* Load(const Columnar::Block& block, std::vector<char>& scratch) const
+    {
+        if (block.offset + block.storedSize > fSize) {
+            throw std::runtime_error("ColumnarFile: block past the end of the file");
+        }
+        const char* data = fData + block.offset;
+        if (block.codec == Columnar::kRaw) return data;
+#ifdef TOYLARTPC_WITH_ZSTD
+        if (block.codec == Columnar::kZstd) {
+            scratch.resize(block.rawSize);
+            const std::size_t n = ZSTD_decompress(scratch.data(), scratch.size(),
+                                                  data, block.storedSize);
+            if (ZSTD_isError(n) || n != block.rawSize) {
+                throw std::runtime_error("ColumnarFile: corrupt zstd block");
+            }
+            return scratch.data();
+        }
+#endif
+        (void)scratch;
+        throw std::runtime_error("ColumnarFile: unsupported block codec "
+                                 + std::to_string(block.codec));
+    }
+
+    bool ReadFooter()
+    {
+        if (fSize < Columnar::kHeaderSize
+            || std::memcmp(fData, Columnar::kMagic, sizeof(Columnar::kMagic)) != 0) {
+            return false;
+        }
+        std::uint32_t version = 0;
+        std::uint64_t footer = 0, footerSize = 0;
+        std::memcpy(&version, fData + 8, sizeof(version));
+        std::memcpy(&footer, fData + 16, sizeof(footer));
+        std::memcpy(&footerSize, fData + 24, sizeof(footerSize));
+        if (version != Columnar::kVersion || footer == 0 || footer + footerSize > fSize) {
+            return false;
+        }
+
+        // Follow the chain back to the first footer, then read oldest first
+        std::vector<std::uint64_t> chain = { footer, footerSize };
+        for (;;) {
+            const std::uint64_t at = chain[chain.size() - 2];
+            if (chain.back() < 16) return false;
+            std::uint64_t previous = 0, previousSize = 0;
+            std::memcpy(&previous, fData + at, sizeof(previous));
+            std::memcpy(&previousSize, fData + at + 8, sizeof(previousSize));
+            if (previous == 0) break;
+            if (previous < Columnar::kHeaderSize || previous + previousSize > at) return false;
+            chain.push_back(previous);
+            chain.push_back(previousSize);
+        }
+        std::vector<std::vector<Chunk>> tails;
+        for (std::size_t i = chain.size(); i > 0; i -= 2) {
+            if (!ReadFooter(chain[i - 2], chain[i - 1], i == chain.size(), tails)) {
+                return false;
+            }
+        }
+        for (std::size_t t = 0; t < fTables.size(); ++t) {
+            auto& chunks = fTables[t].chunks;
+            chunks.insert(chunks.end(), std::make_move_iterator(tails[t].begin()),
+                          std::make_move_iterator(tails[t].end()));
+        }
+        return true;
+    }
+
+    /// Add the chunks listed by one footer to fTables and its tail chunks
+    /// to `tails`; the first (oldest) footer sets up the tables.
+    bool ReadFooter(std::uint64_t footer, std::uint64_t footerSize, bool first,
+                    std::vector<std::vector<Chunk>>& tails)
+    {
+        const char* p   = fData + footer + 16;
+        const char* end = fData + footer + footerSize;
+        auto get = [&](void* out, std::size_t n) {
+            if (static_cast<std::size_t>(end - p) < n) return false;
+            std::memcpy(out, p, n);
+            p += n;
+            return true;
+        };
+        auto getString = [&](std::string& s) {
+            std::uint32_t length = 0;
+            if (!get(&length, sizeof(length)) || static_cast<std::size_t>(end - p) < length) {
+                return false;
+            }
+            s.assign(p, length);
+            p += length;
+            return true;
+        };
+
+        // Every footer repeats the schema; later ones must agree with it
+        std::uint32_t nTables = 0;
+        if (!get(&nTables, sizeof(nTables))) return false;
+        if (first) {
+            fTables.resize(nTables);
+            tails.resize(nTables);
+        }
+        if (nTables != fTables.size()) return false;
+        for (std::size_t t = 0; t < fTables.size(); ++t) {
+            auto& table = fTables[t];
+            auto& tail  = tails[t];
+            Table schema;
+            std::uint32_t nColumns = 0;
+            if (!getString(schema.name) || !getString(schema.title)
+                || !get(&nColumns, sizeof(nColumns))) {
+                return false;
+            }
+            schema.columns.resize(nColumns);
+            std::size_t nBlocks = 0;
+            for (auto& column : schema.columns) {
+                std::uint8_t vector = 0;
+                if (!getString(column.name) || !get(&column.type, 1) || !get(&vector, 1)) {
+                    return false;
+                }
+                column.vector = vector != 0;
+                schema.firstBlock.push_back(nBlocks);
+                nBlocks += column.vector ? 2 : 1;
+            }
+            if (first) {
+                table = std::move(schema);
+            } else if (schema.name != table.name || schema.firstBlock != table.firstBlock) {
+                return false;
+            }
+
+            auto getChunks = [&](std::vector<Chunk>& out) {
+                std::uint32_t nChunks = 0;
+                if (!get(&nChunks, sizeof(nChunks))) return false;
+                for (std::uint32_t c = 0; c < nChunks; ++c) {
+                    Chunk chunk;
+                    chunk.blocks.resize(nBlocks);
+                    if (!get(&chunk.rows, sizeof(chunk.rows))
+                        || !get(chunk.blocks.data(), nBlocks * sizeof(Columnar::Block))) {
+                        return false;
+                    }
+                    out.push_back(std::move(chunk));
+                }
+                return true;
+            };
+
+            // Completed chunks, then the tail of the open chunk
+            std::uint32_t kept = 0;
+            if (!getChunks(table.chunks) || !get(&kept, sizeof(kept)) || kept > tail.size()) {
+                return false;
+            }
+            tail.resize(kept);
+            if (!getChunks(tail)) return false;
+        }
+        return true;
+    }
+
+    void Unmap()
+    {
+        if (fData) ::munmap(const_cast<char*>(fData), fSize);
+        fData = nullptr;
+    }
+
+    const char*        fData = nullptr;
+    std::size_t        fSize = 0;
+    std::vector<Table> fTables;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_COLUMNARFILE_HH
@@ -5,6 +5,7 @@
 #define TOYLARTPC_DETECTORCONSTRUCTION_HH
 
 #include "G4VUserDetectorConstruction.hh"
+#include "globals.hh"
 
 class G4LogicalVolume;
 
@@ -23,9 +24,19 @@ public:
     G4VPhysicalVolume* Construct() override;
     void ConstructSDandField() override;
 
+    /// Text describing every parameter that affects the materials and
+    /// geometry (used to key the physics-table cache).
+    G4String GetConfigurationKey() const;
+
+    /// Wall time [s] spent in the last Construct() on the master thread.
+    static G4double GetConstructionTime() { return fgConstructionTime; }
+
 private:
     bool fFullYield = false;
     G4LogicalVolume* fPhotonDetLogical = nullptr;
+    G4LogicalVolume* fTpcLogical       = nullptr;
+
+    static G4double fgConstructionTime;
 };
 
 } // namespace ToyLArTPC
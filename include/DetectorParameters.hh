@@ -0,0 +1,83 @@
+/// \file DetectorParameters.hh
+/// \brief Geometry and optical constants of the ToyLArTPC detector.
+///
+/// Kept free of Geant4 dependencies so that the standalone tools can share
+/// the detector description.  Values are in Geant4 internal units
+/// (mm, ns, MeV).
+
+#ifndef TOYLARTPC_DETECTORPARAMETERS_HH
+#define TOYLARTPC_DETECTORPARAMETERS_HH
+
+#include <cmath>
+
+namespace ToyLArTPC {
+namespace DetectorParameters {
+
+// --- LArTPC active volume (full lengths) ---
+constexpr double kTpcX = 2000.;    // 2 m  (drift direction)
+constexpr double kTpcY = 10000.;   // 10 m
+constexpr double kTpcZ = 10000.;   // 10 m
+
+// --- Photon detector tiles (full lengths) ---
+constexpr double kTileThickness = 1.;      // 1 mm   (X)
+constexpr double kTileHeight    = 100.;    // 10 cm  (Y)
+constexpr double kTileLength    = 1000.;   // 1 m    (Z)
+
+/// Grid layout: 5 rows (Y) × 5 columns (Z) per wall, two walls at ±x.
+constexpr int kTileRows  = 5;
+constexpr int kTileCols  = 5;
+constexpr int kTileWalls = 2;
+constexpr int kNTiles    = kTileWalls * kTileRows * kTileCols;
+
+// --- Liquid argon optical properties ---
+constexpr double kRefractiveIndex   = 1.38;
+constexpr double kAbsorptionLength  = 600.;     // 60 cm
+constexpr double kRayleighLength    = 900.;     // 90 cm
+constexpr double kFullYieldPerMeV    = 24000.;  // photons / MeV
+constexpr double kReducedYieldPerMeV = 240.;    // photons / MeV
+
+// --- Ionization charge (drift field 500 V/cm, anodes at x = ±kTpcX/2) ---
+constexpr double kIonizationEnergy = 23.6e-6;   // MeV per electron-ion pair
+constexpr double kDriftField       = 0.5;       // kV/cm
+constexpr double kLArDensityGcm3   = 1.396;     // g/cm3
+constexpr double kBoxAlpha         = 0.93;      // Box recombination (ArgoNeuT)
+constexpr double kBoxBeta          = 0.212;     // (kV/cm)(g/cm2)/MeV
+constexpr double kDriftVelocity    = 1.6e-3;    // mm/ns (1.6 mm/us)
+constexpr double kDiffusionL       = 6.2e-7;    // mm2/ns (6.2 cm2/s)
+constexpr double kDiffusionT       = 16.3e-7;   // mm2/ns (16.3 cm2/s)
+constexpr double kElectronLifetime = 3.e6;      // ns (3 ms)
+
+// --- Photon arrival-time histogram (optional ntuple column) ---
+constexpr int    kTimeBins          = 100;
+constexpr int    kTimeBinsPerDecade = 20;
+constexpr double kTimeBinOrigin     = 1.;   // 1 ns: lower edge of bin 1
+
+/// Log-spaced bin of an arrival time `t` (ns after the interaction):
+/// bin 0 holds t < 1 ns, bin i >= 1 holds [10^((i-1)/20), 10^(i/20)) ns,
+/// and the last bin everything later (from about 0.9 ms).
+inline int TimeBin(double t)
+{
+    if (t < kTimeBinOrigin) return 0;
+    const int bin = 1 + static_cast<int>(kTimeBinsPerDecade * std::log10(t / kTimeBinOrigin));
+    return (bin < kTimeBins) ? bin : kTimeBins - 1;
+}
+
+/// Centre of tile `copyNo` (copy numbers run wall-major, then row, then
+/// column, matching the placement order in DetectorConstruction).
+inline void TileCentre(int copyNo, double& x, double& y, double& z)
+{
+    const int wall = copyNo / (kTileRows * kTileCols);
+    const int row  = (copyNo / kTileCols) % kTileRows;
+    const int col  = copyNo % kTileCols;
+
+    // Tiles sit flush against the inner TPC wall, equally spaced on the face.
+    const double xInner = kTpcX / 2 - kTileThickness / 2;
+    x = (wall == 0) ? -xInner : +xInner;
+    y = -kTpcY / 2 + (row + 1) * kTpcY / (kTileRows + 1);
+    z = -kTpcZ / 2 + (col + 1) * kTpcZ / (kTileCols + 1);
+}
+
+} // namespace DetectorParameters
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_DETECTORPARAMETERS_HH
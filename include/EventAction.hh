@@ -4,12 +4,25 @@
 #ifndef TOYLARTPC_EVENTACTION_HH
 #define TOYLARTPC_EVENTACTION_HH
 
+#include "BurstReadout.hh"
+#include "ChargeReadout.hh"
+#include "EventIndex.hh"
+
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 
+#include <vector>
+
 namespace ToyLArTPC {
 
-/// At the end of each event, counts photon hits per tile and fills the ntuple.
+class ChargeSD;
+
+/// At the end of each event, counts photon hits per tile, overlays the
+/// Ar-39 background, applies the trigger and fills the table (dense or
+/// zero-suppressed), plus the charge image of every written event when
+/// the charge readout is on.  Every event, written or not, gets a Truth
+/// row and an entry for the run's event index.  Kept events are also
+/// published to the shared-memory stream when one is open.
 class EventAction : public G4UserEventAction
 {
 public:
@@ -19,8 +32,78 @@ public:
     void BeginOfEventAction(const G4Event* event) override;
     void EndOfEventAction(const G4Event* event)   override;
 
+    /// Called by RunAction at the start of each run.
+    void ResetRunCounters()
+    {
+        fEventsProcessed = 0;
+        fLastEventID     = -1;
+        fCountsRows      = 0;
+        fTruthRows       = 0;
+        fIndexEntries.clear();
+    }
+
+    /// Events finished in this run (written or rejected by the trigger).
+    G4int GetEventsProcessed() const { return fEventsProcessed; }
+    G4int GetLastEventID()     const { return fLastEventID; }
+
+    /// Storage bound to the vector columns of the sparse table.
+    std::vector<G4int>& GetSparseTiles()  { return fSparseTiles; }
+    std::vector<G4int>& GetSparseCounts() { return fSparseCounts; }
+
+    /// Storage bound to the arrival-time histogram column.
+    std::vector<G4int>& GetArrivalTimes() { return fArrivalTimes; }
+
+    /// Storage bound to the vector columns of the ChargeHits table.
+    ChargeImage& GetChargeImage() { return fChargeImage; }
+
+    /// Ntuple entries of the events finished in this run.
+    const std::vector<EventIndexEntry>& GetIndexEntries() const { return fIndexEntries; }
+
+    /// Drop stored optical-photon trajectories of photons that did not
+    /// reach a tile and keep at most `maxPhotons` of the others (0 = all;
+    /// visualization only).
+    void SetKeepDetectedPhotonsOnly(G4bool keep, G4int maxPhotons = 0)
+    {
+        fDetectedPhotonsOnly = keep;
+        fMaxDetectedPhotons  = maxPhotons;
+    }
+
 private:
     G4int fHCID = -1;   ///< Hits collection ID (cached)
+
+    /// Fill one PhotonCounts row; `weight` > 1 marks a prescaled event.
+    void WriteRow(const G4Event* event, const std::vector<G4int>& counts,
+                  G4bool triggered, G4int weight, G4int total);
+
+    /// Read out the event's charge and fill one ChargeHits row.
+    void WriteChargeRow(const G4Event* event);
+
+    /// Fill the event's Truth row and index entry; `countsEntry` is its
+    /// PhotonCounts entry, -1 if it was not written.
+    void WriteTruthRow(const G4Event* event, G4int nPhotons, G4long countsEntry);
+
+    ChargeSD* GetChargeSD();
+
+    G4int fEventsProcessed = 0;    ///< Events finished in this run
+    G4int fLastEventID     = -1;   ///< ID of the last event finished
+
+    G4long fCountsRows = 0;        ///< PhotonCounts rows written in this run
+    G4long fTruthRows  = 0;        ///< Truth rows written in this run
+    std::vector<EventIndexEntry> fIndexEntries;
+
+    G4double fEventStart = 0.;     ///< Wall time at BeginOfEventAction [s]
+
+    std::vector<G4int> fSparseTiles;
+    std::vector<G4int> fSparseCounts;
+    std::vector<G4int> fArrivalTimes;
+
+    ChargeSD*   fChargeSD = nullptr;   ///< Found on first use
+    ChargeImage fChargeImage;
+
+    std::vector<BurstReadout::Record> fBurstHits;   ///< Reused per event
+
+    G4bool fDetectedPhotonsOnly = false;
+    G4int  fMaxDetectedPhotons  = 0;
 };
 
 } // namespace ToyLArTPC
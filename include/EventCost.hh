@@ -0,0 +1,87 @@
+/// \file EventCost.hh
+/// \brief Definition of the ToyLArTPC::EventCost class.
+
+#ifndef TOYLARTPC_EVENTCOST_HH
+#define TOYLARTPC_EVENTCOST_HH
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class G4Event;
+
+namespace ToyLArTPC {
+
+/// Per-event cost records and exact replay of single events.
+///
+/// With recording on, every worker writes one line per event to
+/// `<output>_cost_t<k>.txt` (`<output>_cost.txt` in sequential mode;
+/// `<output>_part<n>_cost...` for later checkpoint or precision segments):
+///
+///   # seed <RandomStreams seed>
+///   global_id event_id wall_s marley_index vx vy vz t0 n_hits engine_state...
+///
+/// where the engine state is the Geant4 engine (put()) at the start of the
+/// event, after the run manager has seeded it.  The application's own
+/// RandomStreams are keyed by the job seed and the global event ID, so the
+/// file header and the record together fix everything the event draws.  A
+/// replay reads both back, sets the seed, runs that one event and restores
+/// the engine before the primaries are generated; the recorded t0 replaces
+/// the burst interaction time, which depends on the event's place in its
+/// run.
+class EventCost
+{
+public:
+    /// Turn recording on (before the run starts).
+    static void   Enable() { fgEnabled = true; }
+    static G4bool IsEnabled() { return fgEnabled; }
+
+    /// Start timing the event with `globalEventID` and capture the engine
+    /// state (PrimaryGeneratorAction, before anything is drawn).
+    static void BeginEvent(std::uint64_t globalEventID);
+
+    /// Write the record of `event` (EndOfEventAction).
+    static void EndEvent(const G4Event* event, std::size_t nHits);
+
+    /// Close this thread's file and print its slowest event (each RunAction).
+    static void EndOfThreadRun();
+
+    /// Find the record of `globalEventID` among the cost files of run
+    /// `output`, its segments included, and prepare its replay, setting
+    /// the RandomStreams seed of that run.  Returns false if there is none.
+    static bool LoadReplay(const std::string& output, std::uint64_t globalEventID);
+
+    static G4bool   IsReplaying() { return fgReplaying; }
+    /// Interaction time [ns] of the replayed event.
+    static G4double GetReplayT0() { return fgReplayT0; }
+
+    /// Put the engine into the recorded start-of-event state.
+    static void RestoreEngine();
+
+private:
+    struct ThreadState {
+        std::FILE*    file   = nullptr;
+        std::uint64_t global = 0;
+        G4double      start  = 0.;
+        std::vector<unsigned long> engineState;   ///< At event start
+        G4double      slowest   = -1.;
+        std::uint64_t slowestID = 0;
+        G4int         events    = 0;
+    };
+
+    static ThreadState& State();
+
+    static G4bool fgEnabled;
+    static G4bool fgReplaying;
+    static std::vector<unsigned long> fgReplayState;
+    static G4double fgReplayT0;
+
+    static G4ThreadLocal ThreadState* fgState;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_EVENTCOST_HH
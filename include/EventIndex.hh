@@ -0,0 +1,151 @@
+/// \file EventIndex.hh
+/// \brief Definition of the ToyLArTPC::EventIndex class.
+///
+/// Kept free of Geant4 dependencies so that the standalone tools can read
+/// the index; only the simulation calls the writing methods, which are
+/// implemented in src/EventIndex.cc.
+
+#ifndef TOYLARTPC_EVENTINDEX_HH
+#define TOYLARTPC_EVENTINDEX_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Where one event of a run went.
+struct EventIndexEntry {
+    std::int64_t event       = -1;   ///< Global event ID
+    std::int64_t file        = -1;   ///< Index into EventIndex::GetFiles()
+    std::int64_t countsEntry = -1;   ///< PhotonCounts entry, -1 if dropped
+    std::int64_t truthEntry  = -1;   ///< Truth entry
+};
+
+/// Sorted on-disk map from global event ID to (file, entry).
+///
+/// Layout: "TLTEVIDX", u32 version, u32 nFiles, per file u32 length and
+/// the name (relative to the directory of the index file, unless
+/// absolute), u64 nEntries, u32 contiguous flag, then the entries sorted by
+/// event ID.  A run's IDs are normally contiguous, so Find() seeks
+/// straight to the entry; otherwise it bisects on disk.  Only the file
+/// names are held in memory.
+class EventIndex
+{
+public:
+    /// Open an index file for lookups.
+    explicit EventIndex(const std::string& path)
+        : fFile(std::fopen(path.c_str(), "rb"))
+    {
+        const auto slash = path.find_last_of('/');
+        if (slash != std::string::npos) fDirectory = path.substr(0, slash + 1);
+        if (!fFile) {
+            throw std::runtime_error("EventIndex: cannot open " + path);
+        }
+        char magic[sizeof(kMagic)] = {};
+        std::uint32_t version = 0, nFiles = 0, contiguous = 0;
+        bool ok = Read(magic, sizeof(magic))
+               && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0
+               && Read(&version, sizeof(version)) && version == kVersion
+               && Read(&nFiles, sizeof(nFiles));
+        for (std::uint32_t f = 0; ok && f < nFiles; ++f) {
+            std::uint32_t length = 0;
+            ok = Read(&length, sizeof(length));
+            std::string name(length, '\0');
+            ok = ok && Read(&name[0], length);
+            fFiles.push_back(name);
+        }
+        ok = ok && Read(&fEntries, sizeof(fEntries)) && Read(&contiguous, sizeof(contiguous));
+        if (!ok) {
+            std::fclose(fFile);
+            throw std::runtime_error("EventIndex: " + path + " is not an event index");
+        }
+        fContiguous = contiguous != 0;
+        fFirstEntry = std::ftell(fFile);
+        if (fEntries > 0) {
+            EventIndexEntry first;
+            ReadEntry(0, first);
+            fFirstEvent = first.event;
+        }
+    }
+
+    ~EventIndex() { std::fclose(fFile); }
+    EventIndex(const EventIndex&) = delete;
+    EventIndex& operator=(const EventIndex&) = delete;
+
+    /// Output files named by the entries, as stored.
+    const std::vector<std::string>& GetFiles() const { return fFiles; }
+
+    /// Path of output file `file`, resolved against the index's directory.
+    std::string GetFilePath(std::int64_t file) const
+    {
+        const auto& name = fFiles.at(static_cast<std::size_t>(file));
+        return (name.empty() || name[0] == '/') ? name : fDirectory + name;
+    }
+    std::uint64_t GetNumberOfEntries() const { return fEntries; }
+
+    /// Look up `event`; returns false if the run did not simulate it.
+    bool Find(std::int64_t event, EventIndexEntry& entry) const
+    {
+        if (fEntries == 0) return false;
+        if (fContiguous) {
+            const std::int64_t k = event - fFirstEvent;
+            if (k < 0 || static_cast<std::uint64_t>(k) >= fEntries) return false;
+            return ReadEntry(static_cast<std::uint64_t>(k), entry) && entry.event == event;
+        }
+        std::uint64_t lo = 0, hi = fEntries;
+        while (lo < hi) {
+            const std::uint64_t mid = lo + (hi - lo) / 2;
+            if (!ReadEntry(mid, entry)) return false;
+            if (entry.event == event) return true;
+            if (entry.event < event) lo = mid + 1; else hi = mid;
+        }
+        return false;
+    }
+
+    // --- Writing (simulation only) ---
+
+    /// Add the events written by one worker to `file` in this run.
+    /// Thread-safe.
+    static void AddThread(const std::string& file, const std::vector<EventIndexEntry>& entries);
+
+    /// Sort everything added since the last call and write it to `path`,
+    /// storing the file names relative to the directory of `path` (master
+    /// thread, after BeamOn).  Returns the number of entries.
+    static std::uint64_t Write(const std::string& path);
+
+private:
+    static constexpr char          kMagic[8] = { 'T', 'L', 'T', 'E', 'V', 'I', 'D', 'X' };
+    static constexpr std::uint32_t kVersion  = 1;
+
+    bool Read(void* data, std::size_t size) const
+    {
+        return size == 0 || std::fread(data, size, 1, fFile) == 1;
+    }
+
+    bool ReadEntry(std::uint64_t k, EventIndexEntry& entry) const
+    {
+        const long offset = fFirstEntry + static_cast<long>(k * sizeof(EventIndexEntry));
+        return std::fseek(fFile, offset, SEEK_SET) == 0 && Read(&entry, sizeof(entry));
+    }
+
+    std::FILE*               fFile = nullptr;
+    std::vector<std::string> fFiles;
+    std::string              fDirectory;   ///< Of the index file, with the '/'
+    std::uint64_t            fEntries    = 0;
+    bool                     fContiguous = false;
+    long                     fFirstEntry = 0;   ///< File offset of entry 0
+    std::int64_t             fFirstEvent = 0;
+
+    static std::mutex                   fgMutex;
+    static std::vector<std::string>     fgFiles;
+    static std::vector<EventIndexEntry> fgEntries;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_EVENTINDEX_HH
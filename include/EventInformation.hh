@@ -0,0 +1,49 @@
+/// \file EventInformation.hh
+/// \brief Definition of the ToyLArTPC::EventInformation class.
+
+#ifndef TOYLARTPC_EVENTINFORMATION_HH
+#define TOYLARTPC_EVENTINFORMATION_HH
+
+#include "G4VUserEventInformation.hh"
+#include "globals.hh"
+
+namespace ToyLArTPC {
+
+/// Generator truth attached to each event by PrimaryGeneratorAction and
+/// written to the Truth ntuple.
+class EventInformation : public G4VUserEventInformation
+{
+public:
+    EventInformation(G4int globalID, G4int marleyIndex, G4double nuEnergy,
+                     G4int stratum = 0, G4double stratumWeight = 1.)
+        : fGlobalID(globalID), fMarleyIndex(marleyIndex), fNuEnergy(nuEnergy),
+          fStratum(stratum), fStratumWeight(stratumWeight) {}
+    ~EventInformation() override = default;
+
+    void Print() const override
+    {
+        G4cout << "Event " << fGlobalID << ": MARLEY event " << fMarleyIndex
+               << ", E_nu = " << fNuEnergy << " MeV" << G4endl;
+    }
+
+    /// Event ID over all runs of the job (keys the output rows).
+    G4int    GetGlobalID()    const { return fGlobalID; }
+    /// Index in the MARLEY event cache (-1 for Ar-39 decays).
+    G4int    GetMarleyIndex() const { return fMarleyIndex; }
+    /// Neutrino energy [MeV] (0 for Ar-39 decays).
+    G4double GetNuEnergy()    const { return fNuEnergy; }
+    /// Vertex stratum and the volume fraction it stands for (VertexSampler).
+    G4int    GetStratum()       const { return fStratum; }
+    G4double GetStratumWeight() const { return fStratumWeight; }
+
+private:
+    G4int    fGlobalID    = -1;
+    G4int    fMarleyIndex = -1;
+    G4double fNuEnergy    = 0.;
+    G4int    fStratum       = 0;
+    G4double fStratumWeight = 1.;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_EVENTINFORMATION_HH
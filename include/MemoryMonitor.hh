@@ -0,0 +1,69 @@
+/// \file MemoryMonitor.hh
+/// \brief Definition of the ToyLArTPC::MemoryMonitor class.
+
+#ifndef TOYLARTPC_MEMORYMONITOR_HH
+#define TOYLARTPC_MEMORYMONITOR_HH
+
+#include "globals.hh"
+
+#include <cstddef>
+#include <mutex>
+
+namespace ToyLArTPC {
+
+/// Memory accounting for sizing batch jobs.
+///
+/// Each worker tracks its PhotonHit allocator pool, the largest hits
+/// collection of an event and the deepest urgent track stack seen while
+/// optical photons are being stacked; the process RSS is sampled after
+/// every event.  Workers merge their figures at the end of the run and the
+/// master prints them together with the size of the MARLEY event cache.
+class MemoryMonitor
+{
+public:
+    /// Turn monitoring on (before the user actions are built); with
+    /// `perEvent` every worker also prints one line per event.
+    static void   Enable(G4bool perEvent);
+    static G4bool IsEnabled() { return fgEnabled; }
+
+    /// Resident set size of the process in bytes (0 if unavailable).
+    static std::size_t GetResidentBytes();
+
+    /// Urgent-stack depth when an optical photon is stacked (StackingAction).
+    static void RecordStackDepth(G4int depth);
+
+    /// Sample the hit pool and RSS after an event with `nHits` photon hits.
+    static void RecordEvent(G4int eventID, std::size_t nHits);
+
+    /// Merge this thread's figures into the run totals (each RunAction).
+    static void EndOfThreadRun();
+
+    /// Print the run totals and reset them (master thread, after BeamOn).
+    static void Report();
+
+private:
+    struct Usage {
+        std::size_t hitPoolBytes   = 0;   ///< PhotonHit allocator pool
+        std::size_t peakHits       = 0;   ///< Largest hits collection
+        G4int       peakStackDepth = 0;
+        G4int       eventStackDepth = 0;  ///< Deepest stack in this event
+        std::size_t peakResident   = 0;
+        G4int       events         = 0;
+    };
+
+    static Usage& ThreadUsage();
+
+    static G4bool fgEnabled;
+    static G4bool fgPerEvent;
+
+    static G4ThreadLocal Usage* fgThreadUsage;
+
+    static std::mutex  fgMutex;
+    static Usage       fgRun;            ///< Maxima over threads
+    static std::size_t fgTotalHitPools;  ///< Sum of the thread pools
+    static G4int       fgThreads;        ///< Threads merged into fgRun
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_MEMORYMONITOR_HH
@@ -0,0 +1,114 @@
+/// \file NativeOutputSink.hh
+/// \brief Definition of the ToyLArTPC::NativeOutputSink class.
+
+#ifndef TOYLARTPC_NATIVEOUTPUTSINK_HH
+#define TOYLARTPC_NATIVEOUTPUTSINK_HH
+
+#include "ColumnarFile.hh"
+#include "OutputSink.hh"
+
+#include <cstdio>
+
+namespace ToyLArTPC {
+
+/// OutputSink writing the native columnar format of ColumnarFile.hh, one
+/// <base>[_t<k>].tlc file per thread.
+///
+/// Rows are buffered column by column and written as a chunk every
+/// kChunkRows rows (or kChunkBytes buffered bytes), optionally compressing
+/// each block with zstd; a block that does not shrink is stored raw.
+/// Nothing is converted or copied besides appending the values, and no
+/// dictionary or streamer machinery is involved.
+///
+/// A flush leaves the open chunks open: it writes their rows added since
+/// the last flush as tail pieces, then a footer listing only the new chunks
+/// and pieces and chained to the previous footer.  Once a chunk is full,
+/// or at Close, it is written whole and its pieces become dead bytes, so
+/// at most one copy of the data is dead.  Close writes one consolidated
+/// footer.
+class NativeOutputSink : public OutputSink
+{
+public:
+    static constexpr std::size_t kChunkRows  = 16384;
+    static constexpr std::size_t kChunkBytes = 16u << 20;
+
+    /// `compression`: zstd level of the blocks, 0 to store them raw.
+    explicit NativeOutputSink(G4int compression);
+    ~NativeOutputSink() override;
+
+    G4int CreateTable(const G4String& name, const G4String& title) override;
+    void  CreateIColumn(const G4String& name) override;
+    void  CreateFColumn(const G4String& name) override;
+    void  CreateDColumn(const G4String& name) override;
+    void  CreateIColumn(const G4String& name, std::vector<G4int>& values) override;
+    void  CreateFColumn(const G4String& name, std::vector<G4float>& values) override;
+    void  FinishTable() override {}
+
+    void FillIColumn(G4int table, G4int column, G4int value) override;
+    void FillFColumn(G4int table, G4int column, G4float value) override;
+    void FillDColumn(G4int table, G4int column, G4double value) override;
+
+protected:
+    void     DoAddRow(G4int table) override;
+    G4String DoOpen(const G4String& baseName) override;
+    void     DoFlush() override;
+    void     DoClose() override;
+
+private:
+    struct Column {
+        G4String     name;
+        std::uint8_t type   = Columnar::kInt32;
+        G4bool       vector = false;
+        unsigned char value[8] = {};                 ///< Current scalar value
+        std::vector<G4int>*   ints   = nullptr;      ///< Bound vector storage
+        std::vector<G4float>* floats = nullptr;
+        std::vector<char>          data;             ///< Values of the open chunk
+        std::vector<std::uint64_t> ends;             ///< Row ends (vector columns)
+        std::size_t flushedData = 0;                 ///< Of those, bytes in tail pieces
+        std::size_t flushedEnds = 0;                 ///< Row ends in tail pieces
+    };
+
+    struct Chunk {
+        std::uint64_t                rows = 0;
+        std::vector<Columnar::Block> blocks;
+    };
+
+    struct Table {
+        G4String            name, title;
+        std::vector<Column> columns;
+        std::uint64_t       rows  = 0;    ///< Rows in the open chunk
+        std::size_t         bytes = 0;    ///< Bytes buffered in the open chunk
+        std::uint64_t       flushedRows = 0;   ///< Rows of the open chunk in `tail`
+        std::vector<Chunk>  chunks;       ///< Chunks written to this file
+        std::size_t         listedChunks = 0;  ///< Chunks listed by a footer
+        std::vector<Chunk>  tail;         ///< Pieces of the open chunk written by flushes
+        std::size_t         listedTail = 0;    ///< Pieces listed by a footer
+    };
+
+    Column& AddColumn(const G4String& name, std::uint8_t type);
+
+    template <typename T>
+    void Store(G4int table, G4int column, T value);
+
+    void            WriteChunk(Table& table);
+    void            WriteTail(Table& table);
+    void            ResetOpenChunk(Table& table);
+    Columnar::Block WriteBlock(const void* data, std::size_t size);
+    void            WriteFooter(G4bool consolidate);
+
+    std::vector<Table> fTables;
+    G4int              fCompression = 0;
+    std::FILE*         fFile  = nullptr;
+    std::uint64_t      fEnd   = 0;       ///< File size so far
+    G4bool             fDirty = false;   ///< Rows added since the last footer
+    G4bool             fHasFooter = false;
+    G4bool             fFooterComplete = false;   ///< Last footer lists everything
+    std::uint64_t      fFooterOffset = 0;         ///< Last footer written
+    std::uint64_t      fFooterSize   = 0;
+    std::vector<char>  fBuffer;          ///< Compression / footer scratch
+    std::vector<std::uint64_t> fEnds;    ///< Row ends of a tail piece
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_NATIVEOUTPUTSINK_HH
@@ -0,0 +1,120 @@
+/// \file OutputSink.hh
+/// \brief Definition of the ToyLArTPC::OutputSink class.
+
+#ifndef TOYLARTPC_OUTPUTSINK_HH
+#define TOYLARTPC_OUTPUTSINK_HH
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Per-thread destination of the event tables (PhotonCounts, Truth,
+/// ChargeHits), independent of the file format.
+///
+/// RunAction declares the tables once per worker and opens and closes a
+/// file per run; EventAction fills columns by (table, column) index and
+/// adds rows, as with G4AnalysisManager ntuples.  Vector columns are bound
+/// to storage that the caller refills before each row.  The backend is
+/// chosen once per job: ROOT (RootOutputSink, through G4AnalysisManager)
+/// or the native columnar format (NativeOutputSink, see ColumnarFile.hh).
+///
+/// Time spent adding rows, flushing and closing is accumulated per thread
+/// and reported by the master with the bytes written, so the backends can
+/// be compared on the same job.
+class OutputSink
+{
+public:
+    enum class Backend { Root, Native };
+
+    /// Select the backend and, for the native one, the zstd level of its
+    /// blocks (0: uncompressed).  Master thread, before the actions are built.
+    static void SetBackend(Backend backend, G4int compression = 0);
+    static Backend GetBackend()     { return fgBackend; }
+    static G4int   GetCompression() { return fgCompression; }
+
+    /// This thread's sink, created on first use.
+    static OutputSink* Instance();
+
+    virtual ~OutputSink() = default;
+
+    // --- Schema (once per thread, before the first Open) ---
+
+    /// Start a table; returns its ID (0, 1, ... in creation order).
+    virtual G4int CreateTable(const G4String& name, const G4String& title) = 0;
+    virtual void  CreateIColumn(const G4String& name) = 0;
+    virtual void  CreateFColumn(const G4String& name) = 0;
+    virtual void  CreateDColumn(const G4String& name) = 0;
+    /// Variable-length columns, read from `values` at every AddRow().
+    virtual void  CreateIColumn(const G4String& name, std::vector<G4int>& values) = 0;
+    virtual void  CreateFColumn(const G4String& name, std::vector<G4float>& values) = 0;
+    virtual void  FinishTable() = 0;
+
+    // --- Rows ---
+
+    virtual void FillIColumn(G4int table, G4int column, G4int value) = 0;
+    virtual void FillFColumn(G4int table, G4int column, G4float value) = 0;
+    virtual void FillDColumn(G4int table, G4int column, G4double value) = 0;
+
+    /// Commit the filled row of `table`.
+    void AddRow(G4int table);
+
+    // --- Files ---
+
+    /// Open this thread's file for `baseName` (per-thread suffix and
+    /// extension added by the backend).
+    void Open(const G4String& baseName);
+
+    /// Make every row added so far readable from the file on disk.
+    void Flush();
+
+    /// Flush and close the file and record its size.
+    void Close();
+
+    /// Name of the file opened last, as written.
+    const G4String& GetFileName() const { return fFileName; }
+
+    /// Merge this thread's timing into the job totals (each RunAction).
+    void EndOfThreadRun();
+
+    /// Print the job totals and reset them (master thread, after BeamOn).
+    static void Report();
+
+protected:
+    OutputSink() = default;
+
+    virtual void     DoAddRow(G4int table) = 0;
+    virtual G4String DoOpen(const G4String& baseName) = 0;   ///< Returns the file name
+    virtual void     DoFlush() = 0;
+    virtual void     DoClose() = 0;
+
+    /// File name for `baseName` and `extension` on the calling thread:
+    /// <base>_t<k><ext> on workers, <base><ext> in sequential mode.
+    static G4String ThreadFileName(const G4String& baseName, const G4String& extension);
+
+private:
+    struct Totals {
+        std::uint64_t rows    = 0;
+        std::uint64_t bytes   = 0;
+        G4double      seconds = 0.;
+        G4int         files   = 0;
+    };
+
+    Totals   fThread;     ///< This thread, since the last EndOfThreadRun
+    G4String fFileName;
+
+    static Backend fgBackend;
+    static G4int   fgCompression;
+
+    static G4ThreadLocal OutputSink* fgInstance;
+
+    static std::mutex fgMutex;
+    static Totals     fgJob;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_OUTPUTSINK_HH
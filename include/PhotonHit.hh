@@ -24,18 +24,21 @@ public:
 
     // Setters
     void SetTileID(G4int id)                    { fTileID = id; }
+    void SetTrackID(G4int id)                   { fTrackID = id; }
     void SetTime(G4double t)                    { fTime = t; }
     void SetPosition(const G4ThreeVector& pos)  { fPosition = pos; }
     void SetWavelength(G4double wl)             { fWavelength = wl; }
 
     // Getters
     G4int          GetTileID()     const { return fTileID; }
+    G4int          GetTrackID()    const { return fTrackID; }
     G4double       GetTime()       const { return fTime; }
     G4ThreeVector  GetPosition()   const { return fPosition; }
     G4double       GetWavelength() const { return fWavelength; }
 
 private:
     G4int         fTileID     = -1;
+    G4int         fTrackID    = -1;
     G4double      fTime       = 0.;
     G4ThreeVector fPosition;
     G4double      fWavelength = 0.;
@@ -6,12 +6,15 @@
 
 #include "G4VSensitiveDetector.hh"
 #include "PhotonHit.hh"
+#include "TileHit.hh"
 
 namespace ToyLArTPC {
 
 /// Sensitive detector attached to each photon detector tile.
 /// Records only optical photons; charged particles are ignored.
-/// A configurable detection efficiency is applied per photon.
+/// A configurable detection efficiency is applied per photon.  The
+/// efficiency is shared by all worker-thread instances so that it can be
+/// changed between runs without rebuilding the sensitive detectors.
 class PhotonSD : public G4VSensitiveDetector
 {
 public:
@@ -20,14 +23,23 @@ public:
 
     void   Initialize(G4HCofThisEvent* hce) override;
     G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+    void   EndOfEvent(G4HCofThisEvent* hce) override;
 
     /// Set the photon detection efficiency (0.0 – 1.0).
-    void     SetEfficiency(G4double eff) { fEfficiency = eff; }
-    G4double GetEfficiency() const       { return fEfficiency; }
+    /// Call on the master thread between runs only.
+    static void     SetEfficiency(G4double eff) { fgEfficiency = eff; }
+    static G4double GetEfficiency()             { return fgEfficiency; }
+
+    /// Also build a TileCountsCollection (one TileHit per lit tile) at the
+    /// end of each event, for the visualization heatmap.
+    static void SetBuildTileSummary(G4bool build) { fgBuildTileSummary = build; }
 
 private:
     PhotonHitsCollection* fHitsCollection = nullptr;
-    G4double              fEfficiency     = 1.0;   // default: 100 %
+    TileHitsCollection*   fTileCollection = nullptr;
+
+    static G4double fgEfficiency;          ///< default: 100 %
+    static G4bool   fgBuildTileSummary;
 };
 
 } // namespace ToyLArTPC
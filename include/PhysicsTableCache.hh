@@ -0,0 +1,48 @@
+/// \file PhysicsTableCache.hh
+/// \brief Definition of the ToyLArTPC::PhysicsTableCache class.
+
+#ifndef TOYLARTPC_PHYSICSTABLECACHE_HH
+#define TOYLARTPC_PHYSICSTABLECACHE_HH
+
+#include "globals.hh"
+
+#include <string>
+
+class G4VUserPhysicsList;
+
+namespace ToyLArTPC {
+
+/// On-disk cache of the physics tables built by the master physics list.
+///
+/// Tables are stored under <baseDir>/<hash>, where the hash covers the
+/// physics list, production cuts, Geant4 version and the detector
+/// configuration key.  Any change to these selects a new, empty directory,
+/// so the tables are rebuilt (and stored again) automatically.
+class PhysicsTableCache
+{
+public:
+    /// @param configuration  Text describing everything the tables depend on.
+    PhysicsTableCache(const std::string& baseDir, const std::string& configuration);
+
+    /// Directory holding the tables for this configuration.
+    const std::string& GetDirectory() const { return fDirectory; }
+
+    /// True if tables for this configuration have been stored before.
+    bool IsPopulated() const;
+
+    /// Ask the physics list to retrieve the tables instead of building
+    /// them.  Must be called before G4RunManager::Initialize().
+    void Retrieve(G4VUserPhysicsList* physicsList) const;
+
+    /// Store the tables once they have been built (after the first
+    /// BeamOn, which G4MTRunManager::Initialize() performs internally).
+    bool Store(G4VUserPhysicsList* physicsList) const;
+
+private:
+    std::string fConfiguration;
+    std::string fDirectory;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_PHYSICSTABLECACHE_HH
@@ -0,0 +1,109 @@
+/// \file PrecisionTarget.hh
+/// \brief Definition of the ToyLArTPC::PrecisionTarget class.
+
+#ifndef TOYLARTPC_PRECISIONTARGET_HH
+#define TOYLARTPC_PRECISIONTARGET_HH
+
+#include "DetectorParameters.hh"
+#include "RunAggregates.hh"
+
+#include "globals.hh"
+
+#include <mutex>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Targets of a precision-driven run.  A target of 0 is not applied.
+struct PrecisionSettings {
+    G4double tileMean   = 0.;    ///< Relative error of every tile's mean count
+    G4double vertexMean = 0.;    ///< Relative error of the mean total light per vertex bin
+    G4double minMean    = 0.;    ///< Ignore tiles and bins with a smaller mean [photons]
+    G4int    batch      = 1000;  ///< Events in the first batch
+};
+
+/// Run length chosen by the statistical precision reached.
+///
+/// The master runs the job as a series of BeamOn batches.  Every worker
+/// adds its kept events to its own weighted Welford accumulators (per-tile
+/// counts, total light per RunAggregates vertex bin), allocated on a
+/// cache-line boundary and registered once like the RunAggregates ones.
+/// Between batches the workers are idle; the master merges the
+/// accumulators (Chan et al.) and compares the relative standard error of
+/// each mean with its target.  The next batch is sized from the events the
+/// worst quantity still needs, at most doubling the run, so the job stops
+/// close to the smallest number of events that meets every target.
+///
+/// Prescaled events enter the means with their weight, and the errors
+/// with the effective number of events (sum w)^2 / sum w^2: an event of
+/// weight P is one sample, not P.  Tiles and bins that have seen no
+/// events, or whose mean is below `minMean`, are not constrained; the
+/// others need kMinEvents effective events before their error is trusted.
+class PrecisionTarget
+{
+public:
+    /// Events a quantity needs before its variance estimate counts.
+    static constexpr G4double kMinEvents = 30.;
+
+    /// Enable the targets (master thread, before the run).
+    static void Configure(const PrecisionSettings& settings);
+    static G4bool IsEnabled() { return fgEnabled; }
+    static const PrecisionSettings& GetSettings() { return fgSettings; }
+
+    /// Add one kept event (EndOfEventAction, calling thread's accumulator).
+    static void Fill(const std::vector<G4int>& counts, G4int weight,
+                     G4double x, G4double y, G4double z);
+
+    /// Merge the threads' accumulators after a batch of `processed` events
+    /// in total and print the worst relative errors (master thread, between
+    /// BeamOn calls).  Returns true once every target is met; otherwise
+    /// `next` is the size of the next batch.
+    static G4bool Update(G4long processed, G4long& next);
+
+private:
+    static constexpr G4int kNTiles     = DetectorParameters::kNTiles;
+    static constexpr G4int kVertexBins = RunAggregates::kVertexBins;
+
+    /// Weighted running mean and sum of squared deviations.
+    struct Moments {
+        G4double weight  = 0.;
+        G4double weight2 = 0.;   ///< Sum of squared weights
+        G4double mean    = 0.;
+        G4double m2      = 0.;
+
+        void Add(G4double x, G4double w)
+        {
+            weight  += w;
+            weight2 += w * w;
+            const G4double delta = x - mean;
+            mean += delta * w / weight;
+            m2   += w * delta * (x - mean);
+        }
+        void Merge(const Moments& other);
+
+        /// Effective number of independent events, (sum w)^2 / sum w^2.
+        G4double Effective() const { return weight2 > 0. ? weight * weight / weight2 : 0.; }
+
+        /// Standard error of the mean over the mean (infinite while undefined).
+        G4double RelativeError() const;
+    };
+
+    struct alignas(64) Accumulator {
+        Moments tile[kNTiles];
+        Moments vertex[kVertexBins];
+    };
+
+    static Accumulator& ThreadAccumulator();
+
+    static G4bool            fgEnabled;
+    static PrecisionSettings fgSettings;
+
+    static G4ThreadLocal Accumulator* fgThreadAccumulator;
+
+    static std::mutex                fgMutex;        ///< Guards the registry only
+    static std::vector<Accumulator*> fgRegistry;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_PRECISIONTARGET_HH
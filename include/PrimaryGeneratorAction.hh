@@ -7,6 +7,8 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -25,7 +27,9 @@ struct MarleyEventData {
 /// Reads pre-generated MARLEY events from a ROOT file and injects
 /// them into Geant4 as primary vertices.  All events must be loaded
 /// on the main thread via LoadEvents() before any worker threads start.
-/// An atomic counter cycles through events for each Geant4 event.
+/// Event i of a run uses cache entry (base + i), where the base is where
+/// the previous run stopped, so the assignment does not depend on which
+/// thread generates the event.
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
 public:
@@ -37,10 +41,45 @@ public:
     /// Load all events from ROOT file — call on main thread only.
     static void LoadEvents(const std::string& eventFile);
 
+    /// Number of events held in the shared cache.
+    static std::size_t GetNumberOfEvents() { return fgEvents.size(); }
+
+    /// Heap bytes held by the shared cache (one copy).
+    static std::size_t GetEventCacheBytes();
+
+    /// Make the calling worker read a copy of the cache local to NUMA
+    /// `node`; the first worker of each node builds it, so its pages are
+    /// first touched on that node.  Call from a pinned worker thread.
+    static void UseNodeReplica(G4int node);
+
+    /// Set the cache index used by event 0 of the next run; GetNextEvent()
+    /// returns one past the highest index generated so far.
+    /// Call on the master thread between runs only.
+    static void SetNextEvent(int index) { fgNextEvent = index; }
+    static int  GetNextEvent()          { return fgNextEvent; }
+
+    /// Fix the base index of run `runID` (from each RunAction at the start
+    /// of the run; only the first call per run has an effect).
+    static void BeginRun(G4int runID);
+
+    /// Generate Ar-39 beta decays instead of MARLEY events (used to build
+    /// the background library; no event file is needed).
+    static void   SetAr39Mode(G4bool on) { fgAr39Mode = on; }
+    static G4bool IsAr39Mode()           { return fgAr39Mode; }
+
 private:
     /// Shared event cache (loaded once on main thread, then read-only).
     static std::vector<MarleyEventData> fgEvents;
     static std::atomic<int> fgNextEvent;
+    static int              fgRunBase;     ///< Global index of event 0 of the run
+    static int              fgBaseRunID;   ///< Run that fgRunBase belongs to
+    static std::mutex       fgRunMutex;
+
+    /// Per-NUMA-node copies of fgEvents and the one this thread reads.
+    static std::vector<std::unique_ptr<const std::vector<MarleyEventData>>> fgReplicas;
+    static std::mutex fgReplicaMutex;
+    static G4ThreadLocal const std::vector<MarleyEventData>* fgLocalEvents;
+    static G4bool fgAr39Mode;
 };
 
 } // namespace ToyLArTPC
@@ -0,0 +1,86 @@
+/// \file RandomStreams.hh
+/// \brief Definition of the ToyLArTPC::RandomStream and
+///        ToyLArTPC::RandomStreams classes.
+
+#ifndef TOYLARTPC_RANDOMSTREAMS_HH
+#define TOYLARTPC_RANDOMSTREAMS_HH
+
+#include "globals.hh"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ToyLArTPC {
+
+/// One stream of a Philox4x32-10 counter-based generator (Salmon et al.,
+/// "Parallel random numbers: as easy as 1, 2, 3", SC 2011).
+///
+/// The n-th number of a stream is a pure function of (seed, event, stream,
+/// n), so it does not depend on which thread runs the event or when.
+/// Numbers are produced a buffer at a time in a loop over independent
+/// counter blocks that the compiler can vectorize.
+class RandomStream
+{
+public:
+    /// Restart the stream for (seed, event, stream); the buffer is refilled
+    /// lazily on the first draw.
+    void Reset(std::uint64_t seed, std::uint64_t event, std::uint32_t stream);
+
+    /// Uniform in the open interval (0, 1), 53-bit resolution.
+    G4double Flat()
+    {
+        if (fNext == kBufferSize) Refill();
+        return fBuffer[fNext++];
+    }
+
+    /// Poisson-distributed count with the given mean.
+    G4long Poisson(G4double mean);
+
+private:
+    void Refill();
+
+    static constexpr std::size_t kBufferSize = 256;   ///< Numbers per refill
+
+    std::uint32_t fKey[2]  = {};
+    std::uint32_t fStream  = 0;
+    std::uint32_t fEvent[2] = {};
+    std::uint32_t fBlock   = 0;             ///< Next counter block
+    std::size_t   fNext    = kBufferSize;   ///< Next unused buffer entry
+    G4double      fBuffer[kBufferSize];
+};
+
+/// The per-event random streams of the application's own sampling.
+///
+/// Each event uses streams keyed by (global seed, global event ID, stream),
+/// so vertices, detection efficiency and background overlay are identical
+/// for any thread count and event scheduling.  Geant4's own physics keeps
+/// using G4Random, which the multi-threaded run managers reseed per event.
+class RandomStreams
+{
+public:
+    enum Stream : std::uint32_t {
+        kVertex = 0,     ///< Interaction vertex
+        kDecay,          ///< Ar-39 beta energy and direction
+        kDetection,      ///< Photon detection efficiency
+        kBackground,     ///< Ar-39 overlay
+        kPrescale,       ///< Trigger prescale decision
+        kNStreams
+    };
+
+    /// Global seed (master thread, between runs).
+    static void          SetSeed(std::uint64_t seed) { fgSeed = seed; }
+    static std::uint64_t GetSeed()                    { return fgSeed; }
+
+    /// Key this thread's streams to `globalEventID` (start of each event).
+    static void BeginEvent(std::uint64_t globalEventID);
+
+    /// This thread's stream `s` for the current event.
+    static RandomStream& Get(Stream s);
+
+private:
+    static std::uint64_t fgSeed;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_RANDOMSTREAMS_HH
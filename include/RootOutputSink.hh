@@ -0,0 +1,40 @@
+/// \file RootOutputSink.hh
+/// \brief Definition of the ToyLArTPC::RootOutputSink class.
+
+#ifndef TOYLARTPC_ROOTOUTPUTSINK_HH
+#define TOYLARTPC_ROOTOUTPUTSINK_HH
+
+#include "OutputSink.hh"
+
+namespace ToyLArTPC {
+
+/// OutputSink writing one ROOT file per thread through G4AnalysisManager;
+/// tables become TTrees and vector columns std::vector branches.
+class RootOutputSink : public OutputSink
+{
+public:
+    RootOutputSink();
+    ~RootOutputSink() override = default;
+
+    G4int CreateTable(const G4String& name, const G4String& title) override;
+    void  CreateIColumn(const G4String& name) override;
+    void  CreateFColumn(const G4String& name) override;
+    void  CreateDColumn(const G4String& name) override;
+    void  CreateIColumn(const G4String& name, std::vector<G4int>& values) override;
+    void  CreateFColumn(const G4String& name, std::vector<G4float>& values) override;
+    void  FinishTable() override;
+
+    void FillIColumn(G4int table, G4int column, G4int value) override;
+    void FillFColumn(G4int table, G4int column, G4float value) override;
+    void FillDColumn(G4int table, G4int column, G4double value) override;
+
+protected:
+    void     DoAddRow(G4int table) override;
+    G4String DoOpen(const G4String& baseName) override;
+    void     DoFlush() override;
+    void     DoClose() override;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_ROOTOUTPUTSINK_HH
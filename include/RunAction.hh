@@ -4,23 +4,58 @@
 #ifndef TOYLARTPC_RUNACTION_HH
 #define TOYLARTPC_RUNACTION_HH
 
+#include "DetectorParameters.hh"
+
 #include "G4UserRunAction.hh"
 #include "globals.hh"
 
 namespace ToyLArTPC {
 
-/// Opens/closes the ROOT output file and creates the photon-count ntuple.
+class EventAction;
+
+/// Opens/closes the output file through the OutputSink and creates the
+/// photon-count table, the Truth sidecar and, with the charge readout on,
+/// the charge table.
 class RunAction : public G4UserRunAction
 {
 public:
-    RunAction();
+    explicit RunAction(EventAction* eventAction);
     ~RunAction() override = default;
 
     void BeginOfRunAction(const G4Run* run) override;
     void EndOfRunAction(const G4Run* run)   override;
 
     /// Total number of photon detector tiles (2 walls × 25 tiles).
-    static constexpr G4int kNTiles = 50;
+    static constexpr G4int kNTiles = DetectorParameters::kNTiles;
+
+    /// Table (ntuple) IDs.  Truth has one row per simulated event; PhotonCounts
+    /// and ChargeHits one per written event, joined on event_id.
+    static constexpr G4int kCountsNtuple = 0;
+    static constexpr G4int kTruthNtuple  = 1;
+    static constexpr G4int kChargeNtuple = 2;
+
+    /// Base name of the output file opened at the start of each run
+    /// (per-thread suffixes and the extension are added by the sink).
+    /// Call on the master thread between runs only.
+    static void SetOutputFileName(const G4String& name) { fgOutputFileName = name; }
+    static const G4String& GetOutputFileName()         { return fgOutputFileName; }
+
+    /// Store only the lit tiles of each event as (tile, count) pairs
+    /// instead of one column per tile.  Set before the actions are built.
+    static void   SetSparseOutput(G4bool sparse) { fgSparseOutput = sparse; }
+    static G4bool IsSparseOutput()               { return fgSparseOutput; }
+
+    /// Add a per-event arrival-time histogram column "arrival_time"
+    /// (DetectorParameters::kTimeBins bins).  Set before the actions are built.
+    static void   SetArrivalTimes(G4bool on) { fgArrivalTimes = on; }
+    static G4bool HasArrivalTimes()          { return fgArrivalTimes; }
+
+private:
+    EventAction* fEventAction = nullptr;
+
+    static G4String fgOutputFileName;
+    static G4bool   fgSparseOutput;
+    static G4bool   fgArrivalTimes;
 };
 
 } // namespace ToyLArTPC
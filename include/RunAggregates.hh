@@ -0,0 +1,91 @@
+/// \file RunAggregates.hh
+/// \brief Definition of the ToyLArTPC::RunAggregates class.
+
+#ifndef TOYLARTPC_RUNAGGREGATES_HH
+#define TOYLARTPC_RUNAGGREGATES_HH
+
+#include "DetectorParameters.hh"
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Run-level aggregates for calibration runs that need no per-event rows.
+///
+/// Every worker fills its own accumulator, allocated on a cache-line
+/// boundary and registered once, so the fills need neither locks nor
+/// atomics and never share a line with another thread.  After BeamOn the
+/// master merges the registered accumulators and writes one small summary
+/// file with the per-tile mean, RMS and occupancy, per-tile count
+/// histograms, the total-light spectrum, the photon arrival-time profile
+/// and light and occupancy versus vertex position.
+class RunAggregates
+{
+public:
+    /// Count histograms use octave bins: 0, 1, 2-3, 4-7, ...
+    static constexpr G4int kCountBins = 32;
+
+    /// Vertex bins (x: drift, y, z) over the TPC.
+    static constexpr G4int kVertexBinsX = 4;
+    static constexpr G4int kVertexBinsY = 10;
+    static constexpr G4int kVertexBinsZ = 10;
+    static constexpr G4int kVertexBins  = kVertexBinsX * kVertexBinsY * kVertexBinsZ;
+
+    /// Vertex bin of a position [mm]: (ix * kVertexBinsY + iy) * kVertexBinsZ + iz.
+    static G4int VertexBin(G4double x, G4double y, G4double z);
+
+    /// Aggregate instead of writing the PhotonCounts ntuple (before the
+    /// user actions are built).
+    static void   Enable() { fgEnabled = true; }
+    static G4bool IsEnabled() { return fgEnabled; }
+
+    /// Add one event with tile `counts`, row `weight` (prescale) and its
+    /// vertex (EndOfEventAction, calling thread's accumulator).
+    static void Fill(const std::vector<G4int>& counts, G4int weight,
+                     G4double x, G4double y, G4double z);
+
+    /// Add one photon arriving `time` ns after the interaction, in an event
+    /// of row `weight`.
+    static void FillArrivalTime(G4double time, G4int weight);
+
+    /// Merge all threads' accumulators, write them to `file` and reset
+    /// them (master thread, after BeamOn).  Returns the merged events.
+    static G4double Write(const std::string& file);
+
+private:
+    static constexpr G4int kNTiles = DetectorParameters::kNTiles;
+    static constexpr G4int kNTimes = DetectorParameters::kTimeBins;
+
+    struct alignas(64) Accumulator {
+        G4double events = 0.;                        ///< Sum of weights
+        G4double tileSum[kNTiles]   = {};
+        G4double tileSumSq[kNTiles] = {};
+        G4double tileFired[kNTiles] = {};            ///< Events with count > 0
+        G4double tileCounts[kNTiles][kCountBins] = {};
+        G4double total[kCountBins] = {};
+        G4double arrival[kNTimes]  = {};
+        G4double vertexEvents[kVertexBins] = {};
+        G4double vertexLight[kVertexBins]  = {};
+        G4double vertexFired[kVertexBins]  = {};     ///< Sum of fired tiles
+
+        void Merge(const Accumulator& other);
+    };
+
+    static Accumulator& ThreadAccumulator();
+
+    static G4bool fgEnabled;
+
+    static G4ThreadLocal Accumulator* fgThreadAccumulator;
+
+    static std::mutex                fgMutex;        ///< Guards the registry only
+    static std::vector<Accumulator*> fgRegistry;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_RUNAGGREGATES_HH
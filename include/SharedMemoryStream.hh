@@ -0,0 +1,63 @@
+/// \file SharedMemoryStream.hh
+/// \brief Definition of the ToyLArTPC::SharedMemoryStream class.
+
+#ifndef TOYLARTPC_SHAREDMEMORYSTREAM_HH
+#define TOYLARTPC_SHAREDMEMORYSTREAM_HH
+
+#include "SharedRing.hh"
+
+#include "globals.hh"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+class G4Event;
+
+namespace ToyLArTPC {
+
+/// Publishes the tile counts of every kept event (and optionally its
+/// generator truth) into a shared-memory ring for a live consumer process,
+/// without going through a file.  See SharedRing.hh for the protocol and
+/// the reader; stream_consumer.cc is an example consumer.
+class SharedMemoryStream
+{
+public:
+    enum class Policy { Block, Drop };
+
+    /// Create the segment `name` (e.g. "/toylartpc") with `nSlots` slots,
+    /// rounded up to a power of two (master thread, before BeamOn).
+    static void Open(const std::string& name, G4int nSlots, Policy policy, G4bool truth);
+    static G4bool IsEnabled() { return fgHeader != nullptr; }
+
+    /// Publish one event (EndOfEventAction, any thread).  Under the block
+    /// policy this waits while the ring is full and a consumer is attached
+    /// and reading; with no consumer, or none reading for kStallSeconds,
+    /// the event is dropped and counted instead.
+    static void Publish(const G4Event* event, const std::vector<G4int>& counts,
+                        G4bool triggered, G4int weight, G4int total);
+
+    /// Mark the stream finished, print its statistics and remove the
+    /// segment name (master thread, after BeamOn).  Attached consumers keep
+    /// their mapping and drain what is left.
+    static void Close();
+
+    /// Longest wait on a full ring without the consumer reading.
+    static constexpr G4double kStallSeconds = 10.;
+
+private:
+    static SharedRing::Header* fgHeader;
+    static SharedRing::Slot*   fgSlots;
+    static std::size_t         fgSize;
+    static std::string         fgName;
+    static G4bool              fgTruth;
+
+    static std::mutex    fgMutex;       ///< Makes the workers a single writer
+    static G4double      fgWaitSeconds; ///< Time spent blocked on a full ring
+    static G4bool        fgStalled;     ///< Consumer stopped reading: drop
+    static std::uint64_t fgStalledAt;   ///< `consumed` when it stopped
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_SHAREDMEMORYSTREAM_HH
@@ -0,0 +1,183 @@
+/// \file SharedRing.hh
+/// \brief Layout of the shared-memory event stream and the
+///        ToyLArTPC::RingReader consumer.
+///
+/// Kept free of Geant4 dependencies so that consumer processes can read
+/// the stream; the simulation publishes through SharedMemoryStream.
+
+#ifndef TOYLARTPC_SHAREDRING_HH
+#define TOYLARTPC_SHAREDRING_HH
+
+#include "DetectorParameters.hh"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace ToyLArTPC {
+
+/// POSIX shared-memory segment holding a header and a power-of-two ring of
+/// fixed-size slots, one event per slot.
+///
+/// There is one writer (the simulation; its workers take turns) and one
+/// consumer.  The writer fills slot n % nSlots in place and then publishes
+/// it by storing n + 1 to the slot's sequence number and to `written`
+/// (release).  The consumer reads the record in place once the slot's
+/// sequence is n + 1 (acquire) and hands the slot back by storing n + 1 to
+/// `consumed`.  Nothing is locked and nothing is copied between the
+/// processes.  When the ring is full the writer either waits for the
+/// consumer (block) or discards the event and counts it (drop).  A
+/// blocking writer still drops while no consumer is attached, or while an
+/// attached one has not read anything for a while, so it never hangs.
+namespace SharedRing {
+
+constexpr char          kMagic[8] = { 'T', 'L', 'T', 'R', 'I', 'N', 'G', '1' };
+constexpr std::uint32_t kVersion  = 1;
+
+enum Policy : std::uint32_t { kBlock = 0, kDrop = 1 };
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the ring needs address-free 64-bit atomics");
+
+/// One event.
+struct Record {
+    std::int64_t event     = -1;    ///< Global event ID
+    std::int32_t triggered = 0;
+    std::int32_t weight    = 0;     ///< > 1 for prescaled events
+    std::int32_t total     = 0;     ///< Photons over all tiles
+    std::int32_t hasTruth  = 0;     ///< Truth fields below are filled
+    float        nuEnergy  = 0.f;   ///< MeV
+    float        vertex[3] = {};    ///< mm
+    double       published = 0.;    ///< Steady-clock time of publication [s]
+    std::int32_t counts[DetectorParameters::kNTiles] = {};
+};
+
+struct alignas(64) Slot {
+    std::atomic<std::uint64_t> sequence;   ///< n + 1 once event n is in the slot
+    Record                     record;
+};
+
+struct Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t nSlots;
+    std::uint32_t recordSize;              ///< sizeof(Record), checked by readers
+    std::uint32_t policy;
+    alignas(64) std::atomic<std::uint64_t> written;    ///< Events published
+    alignas(64) std::atomic<std::uint64_t> consumed;   ///< Events handed back
+    std::atomic<std::uint64_t> dropped;                ///< Discarded by kDrop
+    std::atomic<std::uint32_t> closed;                 ///< Writer finished
+    std::atomic<std::uint32_t> readers;                ///< Attached consumers
+};
+
+inline std::size_t SegmentSize(std::uint32_t nSlots)
+{
+    return sizeof(Header) + nSlots * sizeof(Slot);
+}
+
+inline Slot* GetSlots(Header* header)
+{
+    return reinterpret_cast<Slot*>(reinterpret_cast<char*>(header) + sizeof(Header));
+}
+
+/// Clock of Record::published, comparable across processes on one host.
+inline double Now()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace SharedRing
+
+/// Consumer side of the stream.
+///
+///   RingReader reader("/toylartpc");
+///   while (!reader.IsFinished()) {
+///       if (auto* record = reader.Next()) { ...; reader.Release(); }
+///   }
+class RingReader
+{
+public:
+    /// Attach to the segment `name` (as given to -stream); throws if it
+    /// does not exist (yet) or is not a stream.
+    explicit RingReader(const std::string& name)
+    {
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) throw std::runtime_error("RingReader: no stream " + name);
+        struct stat st {};
+        void* map = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(SharedRing::Header)) {
+            fSize = static_cast<std::size_t>(st.st_size);
+            map = ::mmap(nullptr, fSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("RingReader: cannot map " + name);
+        fHeader = static_cast<SharedRing::Header*>(map);
+        if (std::memcmp(fHeader->magic, SharedRing::kMagic, sizeof(SharedRing::kMagic)) != 0
+            || fHeader->version != SharedRing::kVersion
+            || fHeader->recordSize != sizeof(SharedRing::Record)
+            || fSize < SharedRing::SegmentSize(fHeader->nSlots)) {
+            ::munmap(map, fSize);
+            throw std::runtime_error("RingReader: " + name + " is not a compatible stream");
+        }
+        fSlots = SharedRing::GetSlots(fHeader);
+        fMask  = fHeader->nSlots - 1;
+        fNext  = fHeader->consumed.load(std::memory_order_acquire);
+        fHeader->readers.fetch_add(1);
+    }
+
+    ~RingReader()
+    {
+        fHeader->readers.fetch_sub(1);
+        ::munmap(fHeader, fSize);
+    }
+
+    RingReader(const RingReader&) = delete;
+    RingReader& operator=(const RingReader&) = delete;
+
+    /// The next event, read in place, or nullptr if none is published yet.
+    /// Valid until Release().
+    const SharedRing::Record* Next() const
+    {
+        const auto& slot = fSlots[fNext & fMask];
+        if (slot.sequence.load(std::memory_order_acquire) != fNext + 1) return nullptr;
+        return &slot.record;
+    }
+
+    /// Hand the slot of the event returned by Next() back to the writer.
+    void Release()
+    {
+        ++fNext;
+        fHeader->consumed.store(fNext, std::memory_order_release);
+    }
+
+    /// The writer has finished and every event has been read.
+    bool IsFinished() const
+    {
+        return fHeader->closed.load(std::memory_order_acquire) != 0
+            && fNext == fHeader->written.load(std::memory_order_acquire);
+    }
+
+    std::uint64_t GetConsumed() const { return fNext; }
+    std::uint64_t GetDropped()  const { return fHeader->dropped.load(std::memory_order_relaxed); }
+    std::uint32_t GetNumberOfSlots() const { return fHeader->nSlots; }
+
+private:
+    SharedRing::Header* fHeader = nullptr;
+    SharedRing::Slot*   fSlots  = nullptr;
+    std::size_t         fSize   = 0;
+    std::uint64_t       fMask   = 0;
+    std::uint64_t       fNext   = 0;   ///< Sequence of the next event to read
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_SHAREDRING_HH
@@ -0,0 +1,48 @@
+/// \file SimulationServer.hh
+/// \brief Definition of the ToyLArTPC::SimulationServer class.
+
+#ifndef TOYLARTPC_SIMULATIONSERVER_HH
+#define TOYLARTPC_SIMULATIONSERVER_HH
+
+#include <iosfwd>
+#include <string>
+
+class G4RunManager;
+
+namespace ToyLArTPC {
+
+/// Keeps an initialized run manager (geometry, physics tables and the
+/// MARLEY event cache) resident and runs one BeamOn per job request.
+///
+/// A request is a single line of key=value tokens:
+///
+///     first=<index> n=<nEvents> seed=<seed> output=<name> efficiency=<eff>
+///
+/// Only `n` is mandatory; omitted parameters keep their previous value.
+/// Each request is answered with one line starting with "job <id> ok" or
+/// "job <id> error".  The line "quit" stops the server.
+class SimulationServer
+{
+public:
+    explicit SimulationServer(G4RunManager* runManager);
+    ~SimulationServer() = default;
+
+    /// Serve requests read line by line from `in`, answering on `out`.
+    void Serve(std::istream& in, std::ostream& out);
+
+    /// Serve requests from clients of a local Unix socket at `path`,
+    /// one client at a time, until a client sends "quit".
+    void Serve(const std::string& socketPath);
+
+private:
+    /// Run one job; returns the response line (without newline).
+    /// Sets `quit` if the request asks the server to stop.
+    std::string HandleRequest(const std::string& request, bool& quit);
+
+    G4RunManager* fRunManager = nullptr;
+    int           fNextJobID  = 0;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_SIMULATIONSERVER_HH
@@ -0,0 +1,25 @@
+/// \file StackingAction.hh
+/// \brief Definition of the ToyLArTPC::StackingAction class.
+
+#ifndef TOYLARTPC_STACKINGACTION_HH
+#define TOYLARTPC_STACKINGACTION_HH
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+namespace ToyLArTPC {
+
+/// Reports the urgent-stack depth to the MemoryMonitor whenever an optical
+/// photon is stacked.  Classification is left unchanged.
+class StackingAction : public G4UserStackingAction
+{
+public:
+    StackingAction()  = default;
+    ~StackingAction() override = default;
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_STACKINGACTION_HH
@@ -0,0 +1,47 @@
+/// \file ThreadAffinity.hh
+/// \brief Definition of the ToyLArTPC::ThreadAffinity class.
+
+#ifndef TOYLARTPC_THREADAFFINITY_HH
+#define TOYLARTPC_THREADAFFINITY_HH
+
+#include "globals.hh"
+
+#include <string>
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Pins worker threads to CPUs and tells them their NUMA node.
+///
+/// The topology is read from /sys/devices/system/node (one node holding
+/// all CPUs if that is missing) and restricted to the CPUs this process is
+/// allowed to run on.  Worker i is pinned to the i-th CPU of the chosen
+/// order (wrapping around):
+///
+///   compact   all CPUs of node 0, then node 1, ... (fill one socket first)
+///   scatter   round-robin over the nodes (spread memory bandwidth)
+///   <list>    explicit CPU list, e.g. "0-15,32-47"
+class ThreadAffinity
+{
+public:
+    /// Choose the CPU order (master thread, before the workers start).
+    /// Throws std::runtime_error for an unusable order.
+    static void Configure(const std::string& order);
+
+    static G4bool IsEnabled() { return !fgCpuOrder.empty(); }
+
+    /// Pin the calling worker thread; returns the NUMA node of its CPU,
+    /// or -1 if pinning failed.
+    static G4int PinWorker(G4int threadIndex);
+
+    static G4int GetNumberOfNodes() { return fgNodes; }
+
+private:
+    static std::vector<G4int> fgCpuOrder;
+    static std::vector<G4int> fgCpuNode;   ///< NUMA node per CPU number
+    static G4int              fgNodes;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_THREADAFFINITY_HH
@@ -0,0 +1,40 @@
+/// \file TileHit.hh
+/// \brief Definition of the ToyLArTPC::TileHit class.
+
+#ifndef TOYLARTPC_TILEHIT_HH
+#define TOYLARTPC_TILEHIT_HH
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+
+namespace ToyLArTPC {
+
+/// Per-tile photon count of one event, built for visualization only.
+/// Drawn as a box over the tile, coloured from blue (few photons) to red
+/// (the most photons in the event), so a full-yield event costs 50
+/// primitives instead of one marker per detected photon.
+class TileHit : public G4VHit
+{
+public:
+    TileHit(G4int tileID, G4int count, G4double intensity)
+        : fTileID(tileID), fCount(count), fIntensity(intensity) {}
+    ~TileHit() override = default;
+
+    void Draw() override;
+
+    G4int    GetTileID()    const { return fTileID; }
+    G4int    GetCount()     const { return fCount; }
+    G4double GetIntensity() const { return fIntensity; }
+
+private:
+    G4int    fTileID    = -1;
+    G4int    fCount     = 0;
+    G4double fIntensity = 0.;   ///< count / (largest tile count in the event)
+};
+
+// Hits collection type
+using TileHitsCollection = G4THitsCollection<TileHit>;
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_TILEHIT_HH
@@ -0,0 +1,35 @@
+/// \file TrackingAction.hh
+/// \brief Definition of the ToyLArTPC::TrackingAction class.
+
+#ifndef TOYLARTPC_TRACKINGACTION_HH
+#define TOYLARTPC_TRACKINGACTION_HH
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+namespace ToyLArTPC {
+
+/// Decimates the optical-photon trajectories stored for visualization.
+/// Only every `photonStride`-th photon (by track ID) keeps its trajectory,
+/// up to `maxPhotons` per event (0 = no cap).  Trajectories of all other
+/// particles are stored as configured by /tracking/storeTrajectory.
+class TrackingAction : public G4UserTrackingAction
+{
+public:
+    TrackingAction(G4int photonStride, G4int maxPhotons);
+    ~TrackingAction() override = default;
+
+    void PreUserTrackingAction(const G4Track* track)  override;
+    void PostUserTrackingAction(const G4Track* track) override;
+
+private:
+    G4int fPhotonStride   = 1;
+    G4int fMaxPhotons     = 0;
+    G4int fStoredPhotons  = 0;    ///< Photon trajectories kept in this event
+    G4int fEventID        = -1;   ///< Event fStoredPhotons refers to
+    G4int fSavedStoreMode = 0;    ///< Store mode to restore after the track
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_TRACKINGACTION_HH
@@ -0,0 +1,52 @@
+/// \file Trigger.hh
+/// \brief Definition of the ToyLArTPC::Trigger class.
+
+#ifndef TOYLARTPC_TRIGGER_HH
+#define TOYLARTPC_TRIGGER_HH
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace ToyLArTPC {
+
+/// Online trigger applied to the per-tile photon counts of each event.
+///
+/// A tile "fires" when its count reaches `tileThreshold`.  An event passes
+/// when at least `multiplicity` tiles fire and the total count reaches
+/// `totalThreshold`.  Failing events are dropped, or, with prescale P > 0,
+/// kept with probability 1/P and weight P.  The draw comes from the event's
+/// RandomStreams::kPrescale stream, so the same events are kept for any
+/// thread count and scheduling.
+struct TriggerSettings {
+    G4int tileThreshold  = 1;   ///< Photons for a tile to fire
+    G4int multiplicity   = 0;   ///< Fired tiles required (0 = no condition)
+    G4int totalThreshold = 0;   ///< Total photons required (0 = no condition)
+    G4int prescale       = 0;   ///< Keep 1 in N failing events (0 = drop all)
+
+    G4bool IsEnabled() const { return multiplicity > 0 || totalThreshold > 0; }
+};
+
+class Trigger
+{
+public:
+    /// Set the trigger conditions (master thread, before the run).
+    static void Configure(const TriggerSettings& settings) { fgSettings = settings; }
+    static const TriggerSettings& GetSettings() { return fgSettings; }
+    static G4bool IsEnabled() { return fgSettings.IsEnabled(); }
+
+    /// True if the event passes.  Also returns the number of fired tiles
+    /// and the total count, which the sparse output stores.
+    static G4bool Passes(const std::vector<G4int>& counts,
+                         G4int& nFired, G4int& total);
+
+    /// True if the current event, having failed, is kept by the prescale.
+    static G4bool KeepPrescaled();
+
+private:
+    static TriggerSettings fgSettings;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_TRIGGER_HH
@@ -0,0 +1,69 @@
+/// \file VertexSampler.hh
+/// \brief Definition of the ToyLArTPC::VertexSampler class.
+
+#ifndef TOYLARTPC_VERTEXSAMPLER_HH
+#define TOYLARTPC_VERTEXSAMPLER_HH
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ToyLArTPC {
+
+class RandomStream;
+
+/// How interaction vertices are placed in the TPC.
+///
+///   Uniform     independent uniform draws over the whole volume
+///   Stratified  the volume is cut into nx × ny × nz voxels; event g goes
+///               to voxel g mod nVoxels, uniformly within it, so every
+///               voxel receives the same number of events (±1)
+///   Sobol       3-D Sobol sequence, point g, with a nested uniform (Owen)
+///               scramble seeded from the job seed
+///   Grid        user-supplied points, `eventsPerPoint` consecutive events
+///               at each point in turn
+///
+/// Every event records its stratum (voxel or grid point; 0 for the
+/// unstratified samplers) and the stratum weight, the fraction of the
+/// volume the stratum stands for (1/nVoxels, the point's normalized grid
+/// weight, or 1).  A map or volume average is then the stratum means
+/// combined with these weights.
+struct VertexSettings {
+    enum class Sampler { Uniform, Stratified, Sobol, Grid };
+
+    Sampler sampler = Sampler::Uniform;
+    G4int   nx = 4, ny = 10, nz = 10;   ///< Voxels (Stratified)
+    G4int   eventsPerPoint = 1;         ///< Events per grid point (Grid)
+    std::vector<G4double> gridX, gridY, gridZ;   ///< Grid points [mm]
+    std::vector<G4double> gridWeight;            ///< Normalized point weights
+};
+
+class VertexSampler
+{
+public:
+    /// Select the sampler (master thread, before the run).
+    static void Configure(const VertexSettings& settings);
+    static const VertexSettings& GetSettings() { return fgSettings; }
+
+    /// Read grid points "x y z [weight]" (mm, one per line, '#' comments)
+    /// into `settings` and normalize their weights.  Throws on a bad file.
+    static void LoadGrid(const std::string& file, VertexSettings& settings);
+
+    /// Vertex of the event with global index `global`, drawing any jitter
+    /// from `random`.  Returns the stratum and its weight.
+    static void Sample(std::uint64_t global, RandomStream& random,
+                       G4double& x, G4double& y, G4double& z,
+                       G4int& stratum, G4double& weight);
+
+private:
+    /// Scrambled Sobol coordinate `dim` (0-2) of point `index`, in [0, 1).
+    static G4double Sobol(std::uint32_t index, G4int dim);
+
+    static VertexSettings fgSettings;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_VERTEXSAMPLER_HH
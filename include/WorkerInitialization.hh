@@ -0,0 +1,43 @@
+/// \file WorkerInitialization.hh
+/// \brief Definition of the ToyLArTPC::WorkerInitialization class.
+
+#ifndef TOYLARTPC_WORKERINITIALIZATION_HH
+#define TOYLARTPC_WORKERINITIALIZATION_HH
+
+#include "G4UserWorkerInitialization.hh"
+#include "globals.hh"
+
+#include <atomic>
+
+namespace ToyLArTPC {
+
+/// Hooks into worker-thread start-up (multi-threaded run managers only).
+/// Pins the worker when an affinity order is configured.  Records when the
+/// first worker thread started and when the last one became ready, so that
+/// the start-up breakdown can report the worker spin-up time separately
+/// from geometry and physics-table building.
+class WorkerInitialization : public G4UserWorkerInitialization
+{
+public:
+    WorkerInitialization()  = default;
+    ~WorkerInitialization() override = default;
+
+    void WorkerInitialize() const override;
+    void WorkerStart() const override;
+
+    /// Seconds since the steady-clock epoch at which the first worker
+    /// thread started / the last worker thread became ready (0 if none).
+    static G4double GetFirstWorkerInitialize() { return fgFirstInitialize; }
+    static G4double GetLastWorkerStart()       { return fgLastStart; }
+
+    /// Current steady-clock time in the same units as the getters above.
+    static G4double Now();
+
+private:
+    static std::atomic<G4double> fgFirstInitialize;
+    static std::atomic<G4double> fgLastStart;
+};
+
+} // namespace ToyLArTPC
+
+#endif // TOYLARTPC_WORKERINITIALIZATION_HH
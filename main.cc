@@ -4,6 +4,10 @@
 /// Usage:
 ///   ./ToyLArTPC <events.root>                                    Interactive mode (Qt)
 ///   ./ToyLArTPC <events.root> -n <nEvents> [-t <nThreads>]       Batch mode
+///   ./ToyLArTPC <events.root> -server [-socket <path>]            Server mode
+///   ./ToyLArTPC <events.root> -resume <checkpoint>                Resume a batch job
+///   ./ToyLArTPC -ar39-library <library> -n <nDecays>             Build the Ar-39 library
+///   ./ToyLArTPC <events.root> -replay <eventID> [-trace]         Re-run one recorded event
 
 #include "G4RunManagerFactory.hh"
 #include "G4UImanager.hh"
@@ -11,13 +15,42 @@
 #include "G4VisExecutive.hh"
 #include "FTFP_BERT.hh"
 #include "G4OpticalPhysics.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Version.hh"
+#include "Randomize.hh"
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "BackgroundLibrary.hh"
+#include "BurstReadout.hh"
+#include "ChargeReadout.hh"
+#include "ChargeSD.hh"
+#include "Checkpoint.hh"
+#include "EventCost.hh"
+#include "EventIndex.hh"
+#include "MemoryMonitor.hh"
+#include "OutputSink.hh"
+#include "PhotonSD.hh"
+#include "PhysicsTableCache.hh"
+#include "PrecisionTarget.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "RandomStreams.hh"
+#include "RunAction.hh"
+#include "RunAggregates.hh"
+#include "SharedMemoryStream.hh"
+#include "SimulationServer.hh"
+#include "ThreadAffinity.hh"
+#include "Trigger.hh"
+#include "VertexSampler.hh"
+#include "WorkerInitialization.hh"
 
+#include <algorithm>
 #include <string>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 
 namespace {
 
@@ -26,17 +59,135 @@ void PrintUsage()
     std::cerr << "Usage:\n"
               << "  ToyLArTPC <events.root>                                       Interactive (Qt)\n"
               << "  ToyLArTPC <events.root> -n <nEvents> [-t <nThreads>] [-full-yield]  Batch\n"
+              << "  ToyLArTPC <events.root> -server [-socket <path>] [-t <nThreads>]   Server\n"
+              << "  ToyLArTPC -ar39-library <file> -n <nDecays> [-t <nThreads>]       Ar-39 library\n"
+              << "  ToyLArTPC <events.root> -replay <eventID> [-trace]             Replay one event\n"
               << "\n"
               << "Options:\n"
               << "  -n <nEvents>   Number of events to simulate (omit for interactive mode)\n"
               << "  -t <nThreads>  Number of worker threads (0 = auto)\n"
+              << "  -affinity <order>  Pin workers to CPUs: compact (fill one socket first),\n"
+              << "                 scatter (round-robin over sockets) or a list like 0-15,32-47;\n"
+              << "                 on multi-socket nodes the event cache is replicated per socket\n"
               << "  -full-yield    Use physical scintillation yield (24000 ph/MeV)\n"
               << "                 Default is reduced yield (240 ph/MeV) for fast runs\n"
+              << "  -efficiency <e>  Photon detection efficiency (0 - 1, default 1)\n"
+              << "  -seed <seed>   Random seed; events are reproducible for any thread count\n"
+              << "  -server        Initialize once, then run one job per request line read\n"
+              << "                 from stdin (or from the socket given with -socket):\n"
+              << "                   first=<index> n=<nEvents> seed=<seed> output=<name> efficiency=<e>\n"
+              << "  -socket <path> Accept server requests on a local Unix socket\n"
+              << "  -physics-cache <dir>  Store physics tables in <dir> on the first run and\n"
+              << "                 retrieve them on later runs with the same configuration\n"
+              << "  -output <name> Output file name without extension (default ToyLArTPC;\n"
+              << "                 multi-threaded runs write <name>_t<k>.root per worker,\n"
+              << "                 plus <name>.index mapping event IDs to file and entry)\n"
+              << "  -output-format <root|native>  ROOT files (default) or the native columnar\n"
+              << "                 format (<name>_t<k>.tlc, memory-mappable, see ColumnarFile.hh)\n"
+              << "  -zstd <level>  Compress the blocks of native files with zstd\n"
+              << "  -sparse        Store only lit tiles, as (tile, count) pairs per event\n"
+              << "  -charge <pixel|wire>  Simulate ionization charge: recombination, drift to\n"
+              << "                 the anodes at x = +-1 m with diffusion and attachment, and\n"
+              << "                 a pixel or wire readout (ChargeHits ntuple)\n"
+              << "  -truth-edep    Record the energy deposited in the TPC in the Truth ntuple\n"
+              << "                 (always with -charge; costs time on every TPC step)\n"
+              << "  -pixel-pitch <mm>  Pixel / wire pitch (default 4)\n"
+              << "  -charge-tick <ns>  Charge sampling period (default 500)\n"
+              << "  -charge-threshold <e>  Zero suppression per cell in electrons (default 100)\n"
+              << "  -electron-lifetime <ms>  Electron lifetime (default 3)\n"
+              << "  -aggregate     Write only run-level aggregates (per-tile moments, count\n"
+              << "                 histograms, arrival times, light versus vertex) to\n"
+              << "                 <output>_aggregate.root instead of per-event rows\n"
+              << "                 (one per job in server mode)\n"
+              << "  -stream <name> Publish the tile counts of every kept event to the POSIX\n"
+              << "                 shared-memory ring <name> (e.g. /toylartpc) for a live\n"
+              << "                 consumer such as StreamConsumer\n"
+              << "  -stream-slots <N>  Events the ring holds (default 1024)\n"
+              << "  -stream-drop   Drop events while the ring is full instead of waiting\n"
+              << "                 for the consumer (events are dropped anyway while no\n"
+              << "                 consumer is attached or one stops reading)\n"
+              << "  -stream-truth  Add the neutrino energy and vertex to each streamed event\n"
+              << "  -precision-tile <r>  Run in batches until the mean count of every lit tile\n"
+              << "                 has a relative standard error below r; -n is then the\n"
+              << "                 most events to simulate\n"
+              << "  -precision-vertex <r>  As -precision-tile, for the mean total light of\n"
+              << "                 every vertex bin (4 x 10 x 10)\n"
+              << "  -precision-min-mean <N>  Leave tiles and bins with a mean below N photons\n"
+              << "                 unconstrained (default 0)\n"
+              << "  -precision-batch <N>  Events in the first batch (default 1000); later\n"
+              << "                 batches are sized from the precision reached, each\n"
+              << "                 writing <output>_part<k>\n"
+              << "  -vertex-sampler <uniform|stratified|sobol|grid>  Vertex placement: uniform\n"
+              << "                 (default), stratified over voxels, scrambled Sobol, or a\n"
+              << "                 user grid; the Truth ntuple records each event's stratum\n"
+              << "                 and stratum weight\n"
+              << "  -vertex-strata <nx> <ny> <nz>  Voxels of the stratified sampler (default\n"
+              << "                 4 10 10)\n"
+              << "  -vertex-grid <file>  Grid points, lines \"x y z [weight]\" in mm (implies\n"
+              << "                 -vertex-sampler grid)\n"
+              << "  -vertex-grid-events <N>  Consecutive events per grid point (default 1)\n"
+              << "  -arrival-times  Add a per-event photon arrival-time histogram column\n"
+              << "                 (100 log bins, 20 per decade from 1 ns)\n"
+              << "  -trigger-tile <N>  Photons for a tile to fire (default 1); alone, keeps\n"
+              << "                 events with at least one fired tile\n"
+              << "  -trigger-multiplicity <M>  Keep events with at least M fired tiles\n"
+              << "  -trigger-total <N>  Keep events with at least N photons in total\n"
+              << "  -prescale <P>  Keep events failing the trigger with probability 1/P,\n"
+              << "                 with weight P\n"
+              << "                 (default 0: drop them)\n"
+              << "  -burst <file>  Supernova-burst mode: the -n events are interactions spread\n"
+              << "                 over the burst; write one time-ordered hit stream to <file>\n"
+              << "  -burst-duration <s>  Burst length for the built-in profile (default 10)\n"
+              << "  -burst-profile <file>  Luminosity profile, columns: time[s] rate\n"
+              << "  -burst-window <N>  Max events in flight past the oldest unfinished one\n"
+              << "                 (bounds merge memory, default 64)\n"
+              << "  -ar39-library <file>  Simulate Ar-39 decays (no event file) and store their\n"
+              << "                 tile hits as a background library\n"
+              << "  -ar39-overlay <file>  Overlay Ar-39 background from a library on every event\n"
+              << "  -ar39-rate <Hz>  Ar-39 decay rate in the TPC (default "
+              << ToyLArTPC::BackgroundLibrary::GetDefaultRate() << ")\n"
+              << "  -readout-window <us>  Readout window for the overlay (default 10)\n"
+              << "  -vis-photon-stride <N>  Interactive: draw 1 in N optical-photon\n"
+              << "                 trajectories (default 1, or 100 with -full-yield)\n"
+              << "  -vis-max-photons <N>  Interactive: photon trajectories kept per event\n"
+              << "                 (default unlimited, or 5000 with -full-yield)\n"
+              << "  -vis-detected-only  Interactive: draw only photons that reached a tile\n"
+              << "  -vis-max-events <N>  Interactive: events accumulated in the viewer\n"
+              << "  -memory        Report hit pools, hits, photon stack depth, event cache\n"
+              << "                 and RSS at the end of the run (batch mode)\n"
+              << "  -memory-per-event  As -memory, plus one line per event\n"
+              << "  -event-cost    Write wall time, MARLEY index, vertex, hits and start-of-event\n"
+              << "                 engine state of every event to <output>_cost[_t<k>].txt\n"
+              << "  -replay <eventID>  Re-simulate one event recorded with -event-cost,\n"
+              << "                 single-threaded (same options as the original run; the\n"
+              << "                 seed comes from the record); output goes to\n"
+              << "                 <output>_replay<eventID>\n"
+              << "  -trace         With -replay: step-level tracing (/tracking/verbose 1)\n"
+              << "  -checkpoint-every <N>  Flush output and write a checkpoint after every N\n"
+              << "                 events per thread (batch mode)\n"
+              << "  -checkpoint <file>  Checkpoint file (default ToyLArTPC.checkpoint)\n"
+              << "  -resume <file> Resume an interrupted batch job from its checkpoint; the\n"
+              << "                 remaining events go to <output>_part<k> (join with hadd)\n"
               << "\n"
               << "  Generate the events file first with:\n"
               << "    ./GenerateMarleyEvents marley_config.js <nEvents> events.root\n";
 }
 
+/// Print where the start-up time went (all times in seconds).
+void PrintStartupTimes(G4double eventLoading, G4double geometry,
+                       G4double physicsTables, G4double workerSpinUp)
+{
+    G4cout << std::fixed << std::setprecision(3)
+           << "Start-up time breakdown [s]:\n"
+           << "  event loading    " << eventLoading  << '\n'
+           << "  geometry         " << geometry      << '\n'
+           << "  physics tables   " << physicsTables << '\n'
+           << "  worker spin-up   " << workerSpinUp  << '\n'
+           << "  total            "
+           << (eventLoading + geometry + physicsTables + workerSpinUp)
+           << G4endl << std::defaultfloat;
+}
+
 } // anonymous namespace
 
 int main(int argc, char** argv)
@@ -47,50 +198,515 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    // Building the Ar-39 library needs no event file
     std::string eventFile = argv[1];
+    int firstOption = 2;
+    if (eventFile[0] == '-') {
+        eventFile.clear();
+        firstOption = 1;
+    }
+
     G4int nEvents  = 0;      // 0 means interactive mode
     G4int nThreads = 0;      // 0 means let Geant4 decide
     bool  fullYield = false;  // reduced yield by default
+    bool  server    = false;
+    std::string socketPath;  // empty means requests come from stdin
+    std::string physicsCacheDir;  // empty means no physics-table cache
+    G4int checkpointEvery = 0;    // 0 means no incremental flushing
+    std::string checkpointFile = "ToyLArTPC.checkpoint";
+    std::string resumeFile;
+    G4int visPhotonStride = -1;   // -1 means the yield-dependent default
+    G4int visMaxPhotons   = -1;
+    G4int visMaxEvents    = -1;
+    bool  visDetectedOnly = false;
+    ToyLArTPC::TriggerSettings trigger;
+    bool  tileTrigger = false;
+    std::string burstFile;
+    std::string burstProfile;
+    G4double burstDuration = 10.;   // s
+    G4int    burstWindow   = 64;
+    std::string ar39Library;
+    std::string ar39Overlay;
+    std::string affinity;     // empty means threads are not pinned
+    ToyLArTPC::ChargeSettings charge;
+    bool  chargeReadout = false;
+    long long replayEvent = -1;   // -1 means no replay
+    bool  trace = false;
+    std::string streamName;       // empty means no shared-memory stream
+    G4int streamSlots = 1024;
+    bool  streamDrop  = false;
+    bool  streamTruth = false;
+    ToyLArTPC::PrecisionSettings precision;
+    ToyLArTPC::VertexSettings vertex;
+    std::string vertexSampler = "uniform";
+    std::string vertexGrid;
+    std::string outputFormat = "root";
+    G4int zstdLevel = 0;          // 0 means native blocks are stored raw
 
-    for (int i = 2; i < argc; ++i) {
+    for (int i = firstOption; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "-n" && i + 1 < argc) {
             nEvents = std::stoi(argv[++i]);
         } else if (arg == "-t" && i + 1 < argc) {
             nThreads = std::stoi(argv[++i]);
+        } else if (arg == "-affinity" && i + 1 < argc) {
+            affinity = argv[++i];
         } else if (arg == "-full-yield") {
             fullYield = true;
+        } else if (arg == "-efficiency" && i + 1 < argc) {
+            ToyLArTPC::PhotonSD::SetEfficiency(std::stod(argv[++i]));
+        } else if (arg == "-seed" && i + 1 < argc) {
+            const long seed = std::stol(argv[++i]);
+            ToyLArTPC::RandomStreams::SetSeed(static_cast<std::uint64_t>(seed));
+            G4Random::setTheSeed(seed);
+        } else if (arg == "-server") {
+            server = true;
+        } else if (arg == "-socket" && i + 1 < argc) {
+            server = true;
+            socketPath = argv[++i];
+        } else if (arg == "-physics-cache" && i + 1 < argc) {
+            physicsCacheDir = argv[++i];
+        } else if (arg == "-output" && i + 1 < argc) {
+            ToyLArTPC::RunAction::SetOutputFileName(argv[++i]);
+        } else if (arg == "-output-format" && i + 1 < argc) {
+            outputFormat = argv[++i];
+        } else if (arg == "-zstd" && i + 1 < argc) {
+            zstdLevel = std::stoi(argv[++i]);
+        } else if (arg == "-sparse") {
+            ToyLArTPC::RunAction::SetSparseOutput(true);
+        } else if (arg == "-charge" && i + 1 < argc) {
+            chargeReadout = true;
+            const std::string kind = argv[++i];
+            if (kind != "pixel" && kind != "wire") {
+                PrintUsage();
+                return 1;
+            }
+            charge.wires = (kind == "wire");
+        } else if (arg == "-truth-edep") {
+            ToyLArTPC::ChargeSD::SetEnergyDepositTruth(true);
+        } else if (arg == "-pixel-pitch" && i + 1 < argc) {
+            charge.pitch = std::stod(argv[++i]);
+        } else if (arg == "-charge-tick" && i + 1 < argc) {
+            charge.tick = std::stod(argv[++i]);
+        } else if (arg == "-charge-threshold" && i + 1 < argc) {
+            charge.threshold = std::stod(argv[++i]);
+        } else if (arg == "-electron-lifetime" && i + 1 < argc) {
+            charge.lifetime = std::stod(argv[++i]) * CLHEP::ms;
+        } else if (arg == "-aggregate") {
+            ToyLArTPC::RunAggregates::Enable();
+        } else if (arg == "-stream" && i + 1 < argc) {
+            streamName = argv[++i];
+        } else if (arg == "-stream-slots" && i + 1 < argc) {
+            streamSlots = std::stoi(argv[++i]);
+        } else if (arg == "-stream-drop") {
+            streamDrop = true;
+        } else if (arg == "-stream-truth") {
+            streamTruth = true;
+        } else if (arg == "-precision-tile" && i + 1 < argc) {
+            precision.tileMean = std::stod(argv[++i]);
+        } else if (arg == "-precision-vertex" && i + 1 < argc) {
+            precision.vertexMean = std::stod(argv[++i]);
+        } else if (arg == "-precision-min-mean" && i + 1 < argc) {
+            precision.minMean = std::stod(argv[++i]);
+        } else if (arg == "-precision-batch" && i + 1 < argc) {
+            precision.batch = std::stoi(argv[++i]);
+        } else if (arg == "-vertex-sampler" && i + 1 < argc) {
+            vertexSampler = argv[++i];
+        } else if (arg == "-vertex-strata" && i + 3 < argc) {
+            vertex.nx = std::stoi(argv[++i]);
+            vertex.ny = std::stoi(argv[++i]);
+            vertex.nz = std::stoi(argv[++i]);
+        } else if (arg == "-vertex-grid" && i + 1 < argc) {
+            vertexSampler = "grid";
+            vertexGrid    = argv[++i];
+        } else if (arg == "-vertex-grid-events" && i + 1 < argc) {
+            vertex.eventsPerPoint = std::stoi(argv[++i]);
+        } else if (arg == "-arrival-times") {
+            ToyLArTPC::RunAction::SetArrivalTimes(true);
+        } else if (arg == "-trigger-tile" && i + 1 < argc) {
+            trigger.tileThreshold = std::stoi(argv[++i]);
+            tileTrigger = true;
+        } else if (arg == "-trigger-multiplicity" && i + 1 < argc) {
+            trigger.multiplicity = std::stoi(argv[++i]);
+        } else if (arg == "-trigger-total" && i + 1 < argc) {
+            trigger.totalThreshold = std::stoi(argv[++i]);
+        } else if (arg == "-prescale" && i + 1 < argc) {
+            trigger.prescale = std::stoi(argv[++i]);
+        } else if (arg == "-burst" && i + 1 < argc) {
+            burstFile = argv[++i];
+        } else if (arg == "-burst-duration" && i + 1 < argc) {
+            burstDuration = std::stod(argv[++i]);
+        } else if (arg == "-burst-profile" && i + 1 < argc) {
+            burstProfile = argv[++i];
+        } else if (arg == "-burst-window" && i + 1 < argc) {
+            burstWindow = std::stoi(argv[++i]);
+        } else if (arg == "-ar39-library" && i + 1 < argc) {
+            ar39Library = argv[++i];
+        } else if (arg == "-ar39-overlay" && i + 1 < argc) {
+            ar39Overlay = argv[++i];
+        } else if (arg == "-ar39-rate" && i + 1 < argc) {
+            ToyLArTPC::BackgroundLibrary::SetRate(std::stod(argv[++i]));
+        } else if (arg == "-readout-window" && i + 1 < argc) {
+            ToyLArTPC::BackgroundLibrary::SetReadoutWindow(
+                std::stod(argv[++i]) * CLHEP::us);
+        } else if (arg == "-vis-photon-stride" && i + 1 < argc) {
+            visPhotonStride = std::stoi(argv[++i]);
+        } else if (arg == "-vis-max-photons" && i + 1 < argc) {
+            visMaxPhotons = std::stoi(argv[++i]);
+        } else if (arg == "-vis-detected-only") {
+            visDetectedOnly = true;
+        } else if (arg == "-vis-max-events" && i + 1 < argc) {
+            visMaxEvents = std::stoi(argv[++i]);
+        } else if (arg == "-memory") {
+            ToyLArTPC::MemoryMonitor::Enable(false);
+        } else if (arg == "-memory-per-event") {
+            ToyLArTPC::MemoryMonitor::Enable(true);
+        } else if (arg == "-event-cost") {
+            ToyLArTPC::EventCost::Enable();
+        } else if (arg == "-replay" && i + 1 < argc) {
+            replayEvent = std::stoll(argv[++i]);
+        } else if (arg == "-trace") {
+            trace = true;
+        } else if (arg == "-checkpoint-every" && i + 1 < argc) {
+            checkpointEvery = std::stoi(argv[++i]);
+        } else if (arg == "-checkpoint" && i + 1 < argc) {
+            checkpointFile = argv[++i];
+        } else if (arg == "-resume" && i + 1 < argc) {
+            resumeFile = argv[++i];
         } else {
             PrintUsage();
             return 1;
         }
     }
 
+    if (eventFile.empty() && ar39Library.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    if ((outputFormat != "root" && outputFormat != "native") || zstdLevel < 0
+        || (zstdLevel > 0 && outputFormat != "native")) {
+        PrintUsage();
+        return 1;
+    }
+#ifndef TOYLARTPC_WITH_ZSTD
+    if (zstdLevel > 0) {
+        std::cerr << "-zstd: this build has no zstd support (zstd was not found by CMake)"
+                  << std::endl;
+        return 1;
+    }
+#endif
+    ToyLArTPC::OutputSink::SetBackend(outputFormat == "native"
+                                          ? ToyLArTPC::OutputSink::Backend::Native
+                                          : ToyLArTPC::OutputSink::Backend::Root,
+                                      zstdLevel);
+
+    if (ToyLArTPC::RunAggregates::IsEnabled() && (checkpointEvery > 0 || !resumeFile.empty())) {
+        std::cerr << "-aggregate writes no per-event output to checkpoint" << std::endl;
+        return 1;
+    }
+    if (chargeReadout) {
+        if (ToyLArTPC::RunAggregates::IsEnabled()) {
+            std::cerr << "-charge writes per-event images and cannot be used with -aggregate"
+                      << std::endl;
+            return 1;
+        }
+        if (charge.pitch <= 0. || charge.tick <= 0. || charge.lifetime <= 0.) {
+            PrintUsage();
+            return 1;
+        }
+        ToyLArTPC::ChargeReadout::Configure(charge);
+    }
+
+    if (precision.tileMean > 0. || precision.vertexMean > 0.) {
+        if (checkpointEvery > 0 || !resumeFile.empty() || !burstFile.empty()
+            || replayEvent >= 0 || server) {
+            std::cerr << "-precision-tile and -precision-vertex choose the run length and"
+                      << " cannot be used with -checkpoint-every, -resume, -burst, -replay"
+                      << " or -server" << std::endl;
+            return 1;
+        }
+        if (nEvents <= 0) {
+            std::cerr << "-precision-tile and -precision-vertex need -n, the most events"
+                      << " to simulate" << std::endl;
+            return 1;
+        }
+        ToyLArTPC::PrecisionTarget::Configure(precision);
+    }
+    // The burst interaction times are drawn for a known number of events
+    if (!burstFile.empty()
+        && (server || (nEvents <= 0 && resumeFile.empty() && replayEvent < 0))) {
+        std::cerr << "-burst simulates a fixed number of events and needs -n (batch mode);"
+                  << " it cannot be used with -server or interactively" << std::endl;
+        return 1;
+    }
+
+    // A tile threshold alone means "any tile fires"
+    if (tileTrigger && !trigger.IsEnabled()) {
+        trigger.multiplicity = 1;
+    }
+    if (trigger.prescale > 0 && !trigger.IsEnabled()) {
+        std::cerr << "-prescale needs a trigger condition (-trigger-tile,"
+                  << " -trigger-multiplicity or -trigger-total)" << std::endl;
+        return 1;
+    }
+    ToyLArTPC::Trigger::Configure(trigger);
+    if (vertexSampler == "uniform") {
+        vertex.sampler = ToyLArTPC::VertexSettings::Sampler::Uniform;
+    } else if (vertexSampler == "stratified") {
+        vertex.sampler = ToyLArTPC::VertexSettings::Sampler::Stratified;
+    } else if (vertexSampler == "sobol") {
+        vertex.sampler = ToyLArTPC::VertexSettings::Sampler::Sobol;
+    } else if (vertexSampler != "grid" || vertexGrid.empty()) {
+        PrintUsage();
+        return 1;
+    }
+    try {
+        if (vertexSampler == "grid") {
+            ToyLArTPC::VertexSampler::LoadGrid(vertexGrid, vertex);
+        }
+        ToyLArTPC::VertexSampler::Configure(vertex);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        PrintUsage();
+        return 1;
+    }
+    if (!affinity.empty()) {
+        if (replayEvent >= 0) {
+            std::cerr << "-affinity pins worker threads; -replay runs sequentially" << std::endl;
+            return 1;
+        }
+        try {
+            ToyLArTPC::ThreadAffinity::Configure(affinity);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (!ar39Library.empty()) {
+        ToyLArTPC::PrimaryGeneratorAction::SetAr39Mode(true);
+    }
+    if (!burstFile.empty()) {
+        ToyLArTPC::BurstReadout::Configure(burstFile, burstDuration * CLHEP::s,
+                                           burstProfile, burstWindow);
+    }
+
+    // --- Replay: one recorded event, alone and single-threaded ---
+    if (replayEvent >= 0) {
+        const auto output = ToyLArTPC::RunAction::GetOutputFileName();
+        if (!ToyLArTPC::EventCost::LoadReplay(output, static_cast<std::uint64_t>(replayEvent))) {
+            std::cerr << "No record of event " << replayEvent << " in "
+                      << output << "_cost*.txt (run with -event-cost first)" << std::endl;
+            return 1;
+        }
+        ToyLArTPC::RunAction::SetOutputFileName(
+            output + "_replay" + std::to_string(replayEvent));
+        ToyLArTPC::PrimaryGeneratorAction::SetNextEvent(static_cast<int>(replayEvent));
+        nEvents = 1;
+    }
+
+    // --- Resuming: the checkpoint decides how many events are left ---
+    ToyLArTPC::CheckpointRecord checkpoint;
+    if (!resumeFile.empty()) {
+        if (!ToyLArTPC::Checkpoint::Read(resumeFile, checkpoint)) {
+            std::cerr << "Cannot read checkpoint " << resumeFile << std::endl;
+            return 1;
+        }
+        nEvents = checkpoint.total - checkpoint.completed;
+        if (nEvents <= 0) {
+            std::cout << "Checkpoint " << resumeFile
+                      << ": all " << checkpoint.total << " events done" << std::endl;
+            return 0;
+        }
+        if (checkpointEvery <= 0) checkpointEvery = 1000;
+        checkpointFile = resumeFile;
+    }
+
+    // --- Interactive mode: decimate optical photons and draw tile heatmaps ---
+    const bool interactive = !server && nEvents <= 0;
+    ToyLArTPC::VisOptions vis;
+    if (interactive) {
+        vis.enabled      = true;
+        vis.photonStride = (visPhotonStride > 0) ? visPhotonStride : (fullYield ? 100 : 1);
+        vis.maxPhotons   = (visMaxPhotons >= 0)  ? visMaxPhotons   : (fullYield ? 5000 : 0);
+        vis.detectedOnly = visDetectedOnly;
+        if (visMaxEvents < 0 && fullYield) visMaxEvents = 10;
+        ToyLArTPC::PhotonSD::SetBuildTileSummary(true);
+    }
+
     // Construct the run manager
-    auto runManager = G4RunManagerFactory::CreateRunManager();
+    auto runManager = G4RunManagerFactory::CreateRunManager(
+        (replayEvent >= 0) ? G4RunManagerType::Serial : G4RunManagerType::Default);
+    const bool sequential =
+        runManager->GetRunManagerType() == G4RunManager::sequentialRM;
 
     if (nThreads > 0) {
         runManager->SetNumberOfThreads(nThreads);
     }
+    if (sequential && ToyLArTPC::ThreadAffinity::IsEnabled()) {
+        std::cerr << "Warning: -affinity is ignored by the sequential run manager" << std::endl;
+    }
 
     // --- Load pre-generated events on main thread (ROOT is not thread-safe) ---
-    ToyLArTPC::PrimaryGeneratorAction::LoadEvents(eventFile);
+    const G4double tStart = ToyLArTPC::WorkerInitialization::Now();
+    if (!eventFile.empty()) {
+        ToyLArTPC::PrimaryGeneratorAction::LoadEvents(eventFile);
+    }
+    if (!ar39Overlay.empty()) {
+        ToyLArTPC::BackgroundLibrary::Load(ar39Overlay);
+    }
+    const G4double tEventsLoaded = ToyLArTPC::WorkerInitialization::Now();
 
     // --- Mandatory user initialization classes ---
-    runManager->SetUserInitialization(new ToyLArTPC::DetectorConstruction(fullYield));
+    auto detector = new ToyLArTPC::DetectorConstruction(fullYield);
+    runManager->SetUserInitialization(detector);
 
     auto physicsList = new FTFP_BERT();
     physicsList->RegisterPhysics(new G4OpticalPhysics());
     runManager->SetUserInitialization(physicsList);
 
-    runManager->SetUserInitialization(new ToyLArTPC::ActionInitialization());
+    runManager->SetUserInitialization(new ToyLArTPC::ActionInitialization(vis));
+    if (!sequential) {
+        runManager->SetUserInitialization(new ToyLArTPC::WorkerInitialization());
+    }
+
+    // --- Optional physics-table cache, keyed by everything the tables depend on ---
+    std::unique_ptr<ToyLArTPC::PhysicsTableCache> physicsCache;
+    if (!physicsCacheDir.empty()) {
+        std::ostringstream configuration;
+        configuration << "geant4=" << G4Version
+                      << ";physics=FTFP_BERT+G4OpticalPhysics"
+                      << ";cut=" << physicsList->GetDefaultCutValue()
+                      << ';' << detector->GetConfigurationKey();
+        physicsCache = std::make_unique<ToyLArTPC::PhysicsTableCache>(
+            physicsCacheDir, configuration.str());
+        physicsCache->Retrieve(physicsList);
+    }
 
-    // Initialize the Geant4 kernel
+    // Initialize the Geant4 kernel.  Multi-threaded run managers build the
+    // physics tables and start the workers here; do the same for the
+    // sequential one so that the timing breakdown means the same thing.
     runManager->Initialize();
+    if (sequential) {
+        runManager->BeamOn(0);
+    }
+    const G4double tInitialized = ToyLArTPC::WorkerInitialization::Now();
+
+    if (physicsCache) {
+        physicsCache->Store(physicsList);
+    }
 
-    if (nEvents > 0) {
+    const G4double firstWorker = ToyLArTPC::WorkerInitialization::GetFirstWorkerInitialize();
+    const G4double lastWorker  = ToyLArTPC::WorkerInitialization::GetLastWorkerStart();
+    const G4double geometry    = ToyLArTPC::DetectorConstruction::GetConstructionTime();
+    const G4double workersFrom = (firstWorker > 0.) ? firstWorker : tInitialized;
+    PrintStartupTimes(tEventsLoaded - tStart,
+                      geometry,
+                      workersFrom - tEventsLoaded - geometry,
+                      (firstWorker > 0.) ? lastWorker - firstWorker : 0.);
+
+    if (server) {
+        // ---- Server mode: kernel and event cache stay resident ----
+        ToyLArTPC::SimulationServer simServer(runManager);
+        if (socketPath.empty()) {
+            simServer.Serve(std::cin, std::cout);
+        } else {
+            simServer.Serve(socketPath);
+        }
+    } else if (nEvents > 0) {
         // ---- Batch mode ----
-        runManager->BeamOn(nEvents);
+        if (!resumeFile.empty()) {
+            // Continue the event cursor and write a new output segment
+            ++checkpoint.segment;
+            ToyLArTPC::PrimaryGeneratorAction::SetNextEvent(checkpoint.cursor);
+            ToyLArTPC::RandomStreams::SetSeed(checkpoint.seed);
+            ToyLArTPC::RunAction::SetOutputFileName(
+                checkpoint.output + "_part" + std::to_string(checkpoint.segment));
+
+            // A sequential job continues exactly from the engine state of its
+            // last flush.  Multi-threaded jobs seed every event from the
+            // master engine, so restore that and move to a fresh,
+            // reproducible stream for the new segment.
+            if (sequential && checkpoint.threads.size() == 1) {
+                G4Random::getTheEngine()->get(
+                    checkpoint.threads.begin()->second.randomState);
+            } else if (!checkpoint.masterRandomState.empty()) {
+                G4Random::getTheEngine()->get(checkpoint.masterRandomState);
+                G4Random::setTheSeed(
+                    static_cast<long>(1.e9 * G4UniformRand()) + checkpoint.segment);
+            }
+            std::cout << "Resuming " << resumeFile << ": "
+                      << checkpoint.completed << "/" << checkpoint.total
+                      << " events done, " << nEvents << " to go" << std::endl;
+        } else {
+            checkpoint.total  = nEvents;
+            checkpoint.cursor = ToyLArTPC::PrimaryGeneratorAction::GetNextEvent();
+            checkpoint.output = ToyLArTPC::RunAction::GetOutputFileName();
+            checkpoint.seed   = ToyLArTPC::RandomStreams::GetSeed();
+        }
+
+        if (checkpointEvery > 0) {
+            ToyLArTPC::Checkpoint::Start(checkpointFile, checkpointEvery, checkpoint);
+        }
+        if (ToyLArTPC::BurstReadout::IsEnabled()) {
+            ToyLArTPC::BurstReadout::Start(nEvents);
+        }
+        if (!ar39Library.empty()) {
+            ToyLArTPC::BackgroundLibrary::StartRecording(ar39Library);
+        }
+        if (!streamName.empty()) {
+            ToyLArTPC::SharedMemoryStream::Open(
+                streamName, streamSlots,
+                streamDrop ? ToyLArTPC::SharedMemoryStream::Policy::Drop
+                           : ToyLArTPC::SharedMemoryStream::Policy::Block,
+                streamTruth);
+        }
+        if (trace) {
+            G4UImanager::GetUIpointer()->ApplyCommand("/tracking/verbose 1");
+        }
+        if (ToyLArTPC::PrecisionTarget::IsEnabled()) {
+            // Batches until every target is met, each in its own output
+            // segment; the event IDs continue from batch to batch
+            const auto output = ToyLArTPC::RunAction::GetOutputFileName();
+            G4long processed = 0;
+            G4long batch = std::min<G4long>(precision.batch, nEvents);
+            G4bool met   = false;
+            for (G4int part = 0; batch > 0 && !met; ++part) {
+                if (part > 0) {
+                    ToyLArTPC::RunAction::SetOutputFileName(
+                        output + "_part" + std::to_string(part));
+                }
+                runManager->BeamOn(static_cast<G4int>(batch));
+                processed += batch;
+                G4long next = 0;
+                met   = ToyLArTPC::PrecisionTarget::Update(processed, next);
+                batch = std::min<G4long>(next, nEvents - processed);
+            }
+            if (!met) {
+                std::cout << "PrecisionTarget: stopped at the limit of " << nEvents
+                          << " events before every target was met" << std::endl;
+            }
+            ToyLArTPC::RunAction::SetOutputFileName(output);
+        } else {
+            runManager->BeamOn(nEvents);
+        }
+        if (ToyLArTPC::BurstReadout::IsEnabled()) {
+            ToyLArTPC::BurstReadout::Finish();
+        }
+        ToyLArTPC::SharedMemoryStream::Close();
+        ToyLArTPC::BackgroundLibrary::FinishRecording();
+        if (ToyLArTPC::RunAggregates::IsEnabled()) {
+            ToyLArTPC::RunAggregates::Write(
+                ToyLArTPC::RunAction::GetOutputFileName() + "_aggregate.root");
+        } else {
+            ToyLArTPC::EventIndex::Write(
+                ToyLArTPC::RunAction::GetOutputFileName() + ".index");
+            ToyLArTPC::OutputSink::Report();
+        }
+        if (ToyLArTPC::MemoryMonitor::IsEnabled()) {
+            ToyLArTPC::MemoryMonitor::Report();
+        }
     } else {
         // ---- Interactive mode ----
         G4UIExecutive* ui = new G4UIExecutive(argc, argv);
@@ -98,7 +714,13 @@ int main(int argc, char** argv)
         auto visManager = new G4VisExecutive();
         visManager->Initialize();
 
-        G4UImanager::GetUIpointer()->ApplyCommand("/control/execute init_vis.mac");
+        auto uiManager = G4UImanager::GetUIpointer();
+        uiManager->ApplyCommand("/control/execute init_vis.mac");
+        if (visMaxEvents > 0) {
+            // Cap the primitives kept across events
+            uiManager->ApplyCommand("/vis/scene/endOfEventAction accumulate "
+                                    + std::to_string(visMaxEvents));
+        }
         ui->SessionStart();
 
         delete ui;
@@ -0,0 +1,627 @@
+/// \file reconstruct_events.cc
+/// \brief Standalone fast vertex and energy reconstruction from the tile
+///        counts written by ToyLArTPC.
+///
+/// Usage:
+///   ./ReconstructEvents [-j <nThreads>] [-full-yield] [-efficiency <e>]
+///                       [-grid <mm>] [-write] <output.root> [more.root ...]
+///   ./ReconstructEvents [-full-yield] [-efficiency <e>] [-grid <mm>]
+///                       -index <output.index> -event <eventID>
+///
+/// Each event is fitted by maximising the Poisson likelihood of its 50
+/// tile counts against an expected response mu_i = E * Y * eff * g_i(v),
+/// where g_i is the fraction of isotropically emitted photons reaching
+/// tile i directly (exact solid angle of the tile rectangle times the
+/// attenuation over the distance) plus a small floor for scattered light.
+/// The energy is profiled analytically (E = N / (Y * eff * sum_i g_i)),
+/// leaving a vertex-only likelihood that is scanned on a precomputed grid
+/// (one vectorized multiply-add sweep per fired tile) and then refined by
+/// a pattern search on the exact model.  Files are processed in parallel.
+/// With -index, a single event is looked up in the run's event index and
+/// read directly from its entry, without scanning the output.
+
+#include "DetectorParameters.hh"
+#include "EventIndex.hh"
+
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DP = ToyLArTPC::DetectorParameters;
+
+namespace {
+
+constexpr int kNTiles = DP::kNTiles;
+
+constexpr double kFourPi = 4. * 3.14159265358979323846;
+
+/// Acceptance floor per tile, standing in for scattered light.
+constexpr double kScatterFloor = 1.e-6;
+
+/// Tile geometry in structure-of-arrays form.
+struct TileGeometry {
+    double face[kNTiles];   ///< x of the tile's inner face
+    double yc[kNTiles];
+    double zc[kNTiles];
+
+    TileGeometry()
+    {
+        for (int i = 0; i < kNTiles; ++i) {
+            double x = 0., y = 0., z = 0.;
+            DP::TileCentre(i, x, y, z);
+            face[i] = x - std::copysign(DP::kTileThickness / 2, x);
+            yc[i]   = y;
+            zc[i]   = z;
+        }
+    }
+};
+
+/// Solid angle of the rectangle [a1, a2] x [b1, b2] at distance h along
+/// its normal, in units of 4 pi.
+inline double RectangleSolidAngle(double a1, double a2, double b1, double b2,
+                                  double h)
+{
+    auto f = [h](double a, double b) {
+        return std::atan(a * b / (h * std::sqrt(a * a + b * b + h * h)));
+    };
+    return (f(a2, b2) - f(a1, b2) - f(a2, b1) + f(a1, b1)) / kFourPi;
+}
+
+/// Expected per-tile response and the precomputed vertex grid.
+class ResponseModel
+{
+public:
+    ResponseModel(double photonsPerMeV, double spacing)
+        : fPhotonsPerMeV(photonsPerMeV)
+    {
+        // Direct light is lost to absorption and to Rayleigh scattering
+        fInvAttenuation = 1. / DP::kAbsorptionLength + 1. / DP::kRayleighLength;
+
+        auto axis = [spacing](double length) {
+            const int n = std::max(2, static_cast<int>(std::ceil(length / spacing)) + 1);
+            std::vector<double> values(static_cast<std::size_t>(n));
+            for (int i = 0; i < n; ++i) {
+                values[static_cast<std::size_t>(i)] = -length / 2 + length * i / (n - 1);
+            }
+            return values;
+        };
+        const auto xs = axis(DP::kTpcX - 2. * DP::kTileThickness);
+        const auto ys = axis(DP::kTpcY);
+        const auto zs = axis(DP::kTpcZ);
+
+        for (double x : xs) {
+            for (double y : ys) {
+                for (double z : zs) {
+                    fPointX.push_back(x);
+                    fPointY.push_back(y);
+                    fPointZ.push_back(z);
+                }
+            }
+        }
+        fNPoints = fPointX.size();
+
+        // Tables: ln g[tile][point] (tile-major, so that one tile's row is
+        // contiguous) and ln sum_i g_i per point
+        fLnG.resize(kNTiles * fNPoints);
+        fLnSumG.resize(fNPoints);
+        double g[kNTiles];
+        for (std::size_t p = 0; p < fNPoints; ++p) {
+            const double sum = Acceptances(fPointX[p], fPointY[p], fPointZ[p], g);
+            for (int i = 0; i < kNTiles; ++i) {
+                fLnG[i * fNPoints + p] = static_cast<float>(std::log(g[i]));
+            }
+            fLnSumG[p] = static_cast<float>(std::log(sum));
+        }
+    }
+
+    std::size_t GetNumberOfPoints() const { return fNPoints; }
+
+    /// Fill g[tile] for a vertex and return sum_i g_i.
+    double Acceptances(double x, double y, double z, double* g) const
+    {
+        double sum = 0.;
+        #pragma omp simd reduction(+:sum)
+        for (int i = 0; i < kNTiles; ++i) {
+            const double h  = std::max(std::abs(fTiles.face[i] - x), 0.5);
+            const double dy = fTiles.yc[i] - y;
+            const double dz = fTiles.zc[i] - z;
+            const double omega = RectangleSolidAngle(
+                dy - DP::kTileHeight / 2, dy + DP::kTileHeight / 2,
+                dz - DP::kTileLength / 2, dz + DP::kTileLength / 2, h);
+            const double d = std::sqrt(h * h + dy * dy + dz * dz);
+            g[i] = omega * std::exp(-d * fInvAttenuation) + kScatterFloor;
+            sum += g[i];
+        }
+        return sum;
+    }
+
+    /// Profiled negative log-likelihood at a vertex (energy eliminated),
+    /// up to terms that do not depend on the vertex.
+    double ProfiledNLL(const int* counts, int total, double x, double y,
+                       double z, double& sumG) const
+    {
+        double g[kNTiles];
+        sumG = Acceptances(x, y, z, g);
+        double nll = total * std::log(sumG);
+        for (int i = 0; i < kNTiles; ++i) {
+            if (counts[i] > 0) nll -= counts[i] * std::log(g[i]);
+        }
+        return nll;
+    }
+
+    /// Grid point with the smallest profiled NLL; `nll` is scratch space of
+    /// GetNumberOfPoints() entries.
+    std::size_t ScanGrid(const int* counts, int total, float* nll) const
+    {
+        const std::size_t n = fNPoints;
+        const float*      lnSumG = fLnSumG.data();
+        const float       fTotal = static_cast<float>(total);
+
+        #pragma omp simd
+        for (std::size_t p = 0; p < n; ++p) {
+            nll[p] = fTotal * lnSumG[p];
+        }
+        for (int i = 0; i < kNTiles; ++i) {
+            if (counts[i] == 0) continue;
+            const float  w   = static_cast<float>(counts[i]);
+            const float* lnG = &fLnG[i * n];
+            #pragma omp simd
+            for (std::size_t p = 0; p < n; ++p) {
+                nll[p] -= w * lnG[p];
+            }
+        }
+        return static_cast<std::size_t>(std::min_element(nll, nll + n) - nll);
+    }
+
+    double GetPointX(std::size_t p) const { return fPointX[p]; }
+    double GetPointY(std::size_t p) const { return fPointY[p]; }
+    double GetPointZ(std::size_t p) const { return fPointZ[p]; }
+    double GetPhotonsPerMeV()       const { return fPhotonsPerMeV; }
+
+private:
+    TileGeometry fTiles;
+    double       fPhotonsPerMeV  = 0.;
+    double       fInvAttenuation = 0.;
+
+    std::size_t         fNPoints = 0;
+    std::vector<double> fPointX, fPointY, fPointZ;
+    std::vector<float>  fLnG;
+    std::vector<float>  fLnSumG;
+};
+
+/// Fitted vertex [mm] and visible energy [MeV] of one event.
+struct Fit {
+    bool   ok = false;
+    double x = 0., y = 0., z = 0.;
+    double energy = 0.;
+    double nll    = 0.;
+};
+
+Fit Reconstruct(const ResponseModel& model, const int* counts,
+                std::vector<float>& scratch, double gridSpacing)
+{
+    Fit fit;
+    int total = 0;
+    for (int i = 0; i < kNTiles; ++i) total += counts[i];
+    if (total == 0) return fit;
+
+    // --- Coarse scan over the precomputed grid ---
+    const std::size_t best = model.ScanGrid(counts, total, scratch.data());
+    double v[3] = { model.GetPointX(best), model.GetPointY(best), model.GetPointZ(best) };
+    const double half[3] = { DP::kTpcX / 2 - DP::kTileThickness,
+                             DP::kTpcY / 2, DP::kTpcZ / 2 };
+
+    // --- Pattern search on the exact model ---
+    double sumG = 0.;
+    double nll  = model.ProfiledNLL(counts, total, v[0], v[1], v[2], sumG);
+    for (double step = gridSpacing / 2; step > 1.; ) {
+        bool moved = false;
+        for (int axis = 0; axis < 3; ++axis) {
+            for (double sign : { -1., 1. }) {
+                double trial[3] = { v[0], v[1], v[2] };
+                trial[axis] = std::clamp(trial[axis] + sign * step,
+                                         -half[axis], half[axis]);
+                double trialSumG = 0.;
+                const double trialNLL = model.ProfiledNLL(
+                    counts, total, trial[0], trial[1], trial[2], trialSumG);
+                if (trialNLL < nll) {
+                    std::copy(trial, trial + 3, v);
+                    nll   = trialNLL;
+                    sumG  = trialSumG;
+                    moved = true;
+                }
+            }
+        }
+        if (!moved) step /= 2;
+    }
+
+    fit.ok     = true;
+    fit.x      = v[0];
+    fit.y      = v[1];
+    fit.z      = v[2];
+    fit.energy = total / (model.GetPhotonsPerMeV() * sumG);
+    fit.nll    = nll;
+    return fit;
+}
+
+/// Residual statistics accumulated by one worker.
+struct Summary {
+    long   events = 0, fitted = 0, withTruth = 0, withEnergy = 0;
+    double recoSeconds = 0.;
+    double sum[3] = {}, sum2[3] = {};
+    double energySum = 0., energySum2 = 0.;
+
+    void Add(const Summary& o)
+    {
+        events += o.events; fitted += o.fitted;
+        withTruth += o.withTruth; withEnergy += o.withEnergy;
+        recoSeconds += o.recoSeconds;
+        for (int k = 0; k < 3; ++k) { sum[k] += o.sum[k]; sum2[k] += o.sum2[k]; }
+        energySum += o.energySum; energySum2 += o.energySum2;
+    }
+};
+
+/// Tile-count branches of a PhotonCounts tree, dense or zero-suppressed.
+struct CountsBranches {
+    bool              sparse = false;
+    int               dense[kNTiles] = {};
+    std::vector<int>* tiles  = nullptr;
+    std::vector<int>* values = nullptr;
+
+    bool Bind(TTree* tree, const std::string& path)
+    {
+        sparse = tree->GetBranch("tile") != nullptr;
+        if (sparse) {
+            tree->SetBranchAddress("tile",  &tiles);
+            tree->SetBranchAddress("count", &values);
+            return true;
+        }
+        for (int i = 0; i < kNTiles; ++i) {
+            const std::string name = "sensor_" + std::to_string(i);
+            if (!tree->GetBranch(name.c_str())) {
+                std::cerr << "Error: Branch " << name << " not found in " << path << std::endl;
+                return false;
+            }
+            tree->SetBranchAddress(name.c_str(), &dense[i]);
+        }
+        return true;
+    }
+
+    /// Counts of the current entry into `row` (kNTiles values).
+    void Unpack(int* row) const
+    {
+        if (!sparse) {
+            std::copy(dense, dense + kNTiles, row);
+            return;
+        }
+        std::fill(row, row + kNTiles, 0);
+        for (std::size_t k = 0; k < tiles->size(); ++k) {
+            const int tile = (*tiles)[k];
+            if (tile >= 0 && tile < kNTiles) row[tile] = (*values)[k];
+        }
+    }
+};
+
+/// Make the Truth sidecar's columns readable through `tree`, matched on
+/// event_id (older files carry the truth in PhotonCounts itself).
+void AttachTruth(TFile& file, TTree* tree)
+{
+    if (auto* truth = dynamic_cast<TTree*>(file.Get("Truth"))) {
+        truth->BuildIndex("event_id");
+        tree->AddFriend(truth);
+    }
+}
+
+/// Read and reconstruct `event` alone, located through the event index at
+/// `indexPath`, and print the fit next to its truth.
+bool ProcessEvent(const std::string& indexPath, long long event,
+                  const ResponseModel& model, double gridSpacing)
+{
+    ToyLArTPC::EventIndexEntry entry;
+    std::string path;
+    try {
+        const ToyLArTPC::EventIndex index(indexPath);
+        if (!index.Find(event, entry)) {
+            std::cerr << "Error: Event " << event << " is not in " << indexPath << std::endl;
+            return false;
+        }
+        path = index.GetFilePath(entry.file);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".tlc") == 0) {
+        std::cerr << "Error: " << path << " is native output; only ROOT output is supported"
+                  << std::endl;
+        return false;
+    }
+    TFile file(path.c_str(), "READ");
+    auto* truth = file.IsZombie() ? nullptr : dynamic_cast<TTree*>(file.Get("Truth"));
+    if (!truth) {
+        std::cerr << "Error: Truth tree not found in " << path << std::endl;
+        return false;
+    }
+    double nuEnergy = 0., vertex[3] = {};
+    truth->SetBranchAddress("nu_energy", &nuEnergy);
+    truth->SetBranchAddress("vertex_x",  &vertex[0]);
+    truth->SetBranchAddress("vertex_y",  &vertex[1]);
+    truth->SetBranchAddress("vertex_z",  &vertex[2]);
+    truth->GetEntry(entry.truthEntry);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Event " << event << " (" << path << ")\n"
+              << "  truth   vertex (" << vertex[0] << ", " << vertex[1] << ", " << vertex[2]
+              << ") mm, E_nu " << std::setprecision(3) << nuEnergy << " MeV\n";
+    if (entry.countsEntry < 0) {
+        std::cout << "  not written (rejected by the trigger)" << std::defaultfloat << std::endl;
+        return true;
+    }
+
+    auto* tree = dynamic_cast<TTree*>(file.Get("PhotonCounts"));
+    CountsBranches branches;
+    if (!tree || !branches.Bind(tree, path)) return false;
+    tree->GetEntry(entry.countsEntry);
+    int counts[kNTiles];
+    branches.Unpack(counts);
+
+    std::vector<float> scratch(model.GetNumberOfPoints());
+    const Fit fit = Reconstruct(model, counts, scratch, gridSpacing);
+    if (!fit.ok) {
+        std::cout << "  no photons, not fitted" << std::defaultfloat << std::endl;
+        return true;
+    }
+    std::cout << std::setprecision(1)
+              << "  fitted  vertex (" << fit.x << ", " << fit.y << ", " << fit.z
+              << ") mm, E_vis " << std::setprecision(3) << fit.energy << " MeV\n"
+              << std::defaultfloat << std::flush;
+    return true;
+}
+
+/// Read one output file, reconstruct all its events and accumulate the
+/// residuals.  Optionally write a "Reconstruction" tree to <file>_reco.root.
+bool ProcessFile(const std::string& path, const ResponseModel& model,
+                 double gridSpacing, bool write, Summary& summary)
+{
+    TFile file(path.c_str(), "READ");
+    if (file.IsZombie() || !file.IsOpen()) {
+        std::cerr << "Error: Could not open ROOT file: " << path << std::endl;
+        return false;
+    }
+    auto* tree = dynamic_cast<TTree*>(file.Get("PhotonCounts"));
+    if (!tree) {
+        std::cerr << "Error: PhotonCounts tree not found in " << path << std::endl;
+        return false;
+    }
+
+    AttachTruth(file, tree);
+    CountsBranches branches;
+    if (!branches.Bind(tree, path)) return false;
+    const bool hasTruth = tree->GetBranch("nu_energy") != nullptr;
+    double nuEnergy = 0., truth[3] = {};
+    if (hasTruth) {
+        tree->SetBranchAddress("nu_energy", &nuEnergy);
+        tree->SetBranchAddress("vertex_x",  &truth[0]);
+        tree->SetBranchAddress("vertex_y",  &truth[1]);
+        tree->SetBranchAddress("vertex_z",  &truth[2]);
+    }
+
+    // --- Read everything first, so the timed loop is reconstruction only ---
+    const Long64_t nEntries = tree->GetEntries();
+    std::vector<int>    counts(static_cast<std::size_t>(nEntries) * kNTiles, 0);
+    std::vector<double> trueEnergy(static_cast<std::size_t>(nEntries), 0.);
+    std::vector<double> trueVertex(static_cast<std::size_t>(nEntries) * 3, 0.);
+    for (Long64_t e = 0; e < nEntries; ++e) {
+        tree->GetEntry(e);
+        branches.Unpack(&counts[static_cast<std::size_t>(e) * kNTiles]);
+        trueEnergy[static_cast<std::size_t>(e)] = nuEnergy;
+        std::copy(truth, truth + 3, &trueVertex[static_cast<std::size_t>(e) * 3]);
+    }
+
+    std::vector<Fit>   fits(static_cast<std::size_t>(nEntries));
+    std::vector<float> scratch(model.GetNumberOfPoints());
+    const auto start = std::chrono::steady_clock::now();
+    for (Long64_t e = 0; e < nEntries; ++e) {
+        fits[static_cast<std::size_t>(e)] = Reconstruct(
+            model, &counts[static_cast<std::size_t>(e) * kNTiles], scratch, gridSpacing);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    summary.recoSeconds += elapsed.count();
+
+    // --- Compare with the generator truth ---
+    for (Long64_t e = 0; e < nEntries; ++e) {
+        const auto  i   = static_cast<std::size_t>(e);
+        const auto& fit = fits[i];
+        ++summary.events;
+        if (!fit.ok) continue;
+        ++summary.fitted;
+        if (!hasTruth) continue;
+
+        ++summary.withTruth;
+        const double rec[3] = { fit.x, fit.y, fit.z };
+        for (int k = 0; k < 3; ++k) {
+            const double d = rec[k] - trueVertex[i * 3 + k];
+            summary.sum[k]  += d;
+            summary.sum2[k] += d * d;
+        }
+        if (trueEnergy[i] > 0.) {
+            const double ratio = fit.energy / trueEnergy[i];
+            ++summary.withEnergy;
+            summary.energySum  += ratio;
+            summary.energySum2 += ratio * ratio;
+        }
+    }
+
+    if (write) {
+        std::string outPath = path;
+        if (outPath.size() > 5 && outPath.compare(outPath.size() - 5, 5, ".root") == 0) {
+            outPath.resize(outPath.size() - 5);
+        }
+        outPath += "_reco.root";
+
+        TFile out(outPath.c_str(), "RECREATE");
+        TTree reco("Reconstruction", "Fitted vertex and visible energy (entry-aligned with PhotonCounts)");
+        Fit fit;
+        int ok = 0;
+        reco.Branch("ok",         &ok,         "ok/I");
+        reco.Branch("rec_x",      &fit.x,      "rec_x/D");
+        reco.Branch("rec_y",      &fit.y,      "rec_y/D");
+        reco.Branch("rec_z",      &fit.z,      "rec_z/D");
+        reco.Branch("rec_energy", &fit.energy, "rec_energy/D");
+        reco.Branch("nll",        &fit.nll,    "nll/D");
+        for (const auto& f : fits) {
+            fit = f;
+            ok  = f.ok ? 1 : 0;
+            reco.Fill();
+        }
+        reco.Write();
+        out.Close();
+    }
+    return true;
+}
+
+void PrintUsage()
+{
+    std::cerr << "Usage: ReconstructEvents [options] <output.root> [more.root ...]\n"
+              << "\n"
+              << "Options:\n"
+              << "  -j <nThreads>    Files reconstructed in parallel (default: all cores)\n"
+              << "  -full-yield      Files were simulated with -full-yield (24000 ph/MeV)\n"
+              << "  -efficiency <e>  Photon detection efficiency used in the simulation\n"
+              << "  -grid <mm>       Spacing of the coarse vertex grid (default 250)\n"
+              << "  -write           Write <file>_reco.root with the fitted values\n"
+              << "  -index <file>    Event index written by the run (<output>.index)\n"
+              << "  -event <id>      With -index: reconstruct this event only\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    unsigned nThreads   = std::max(1u, std::thread::hardware_concurrency());
+    bool     fullYield  = false;
+    double   efficiency = 1.;
+    double   spacing    = 250.;   // mm
+    bool     write      = false;
+    std::string indexPath;
+    long long   event = -1;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nThreads = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        } else if (arg == "-full-yield") {
+            fullYield = true;
+        } else if (arg == "-efficiency" && i + 1 < argc) {
+            efficiency = std::stod(argv[++i]);
+        } else if (arg == "-grid" && i + 1 < argc) {
+            spacing = std::stod(argv[++i]);
+        } else if (arg == "-write") {
+            write = true;
+        } else if (arg == "-index" && i + 1 < argc) {
+            indexPath = argv[++i];
+        } else if (arg == "-event" && i + 1 < argc) {
+            event = std::stoll(argv[++i]);
+        } else if (!arg.empty() && arg[0] == '-') {
+            PrintUsage();
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    const bool single = !indexPath.empty();
+    if ((single ? (event < 0 || !files.empty()) : files.empty())
+        || spacing <= 0. || efficiency <= 0.) {
+        PrintUsage();
+        return 1;
+    }
+
+    // --- Build the response model (shared read-only by all workers) ---
+    const double yield = fullYield ? DP::kFullYieldPerMeV : DP::kReducedYieldPerMeV;
+    const auto   tModel = std::chrono::steady_clock::now();
+    const ResponseModel model(yield * efficiency, spacing);
+    const std::chrono::duration<double> modelTime = std::chrono::steady_clock::now() - tModel;
+    std::cout << "Response model: " << model.GetNumberOfPoints() << " grid points, built in "
+              << modelTime.count() << " s" << std::endl;
+
+    if (single) {
+        return ProcessEvent(indexPath, event, model, spacing) ? 0 : 1;
+    }
+
+    // --- Reconstruct the files in parallel ---
+    ROOT::EnableThreadSafety();
+    nThreads = std::min<unsigned>(nThreads, static_cast<unsigned>(files.size()));
+
+    std::atomic<std::size_t> nextFile{0};
+    std::mutex summaryMutex;
+    Summary    summary;
+    bool       failed = false;
+
+    const auto tStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < nThreads; ++t) {
+        workers.emplace_back([&] {
+            Summary local;
+            bool    ok = true;
+            for (std::size_t f; (f = nextFile.fetch_add(1)) < files.size(); ) {
+                ok = ProcessFile(files[f], model, spacing, write, local) && ok;
+            }
+            std::lock_guard<std::mutex> lock(summaryMutex);
+            summary.Add(local);
+            failed = failed || !ok;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - tStart;
+
+    // --- Report ---
+    auto meanRms = [](double sum, double sum2, long n, double& mean, double& rms) {
+        mean = (n > 0) ? sum / n : 0.;
+        rms  = (n > 0) ? std::sqrt(std::max(sum2 / n - mean * mean, 0.)) : 0.;
+    };
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Reconstructed " << summary.fitted << "/" << summary.events
+              << " events from " << files.size() << " files with "
+              << nThreads << " threads\n"
+              << "  wall time        " << wall.count() << " s ("
+              << (wall.count() > 0. ? summary.events / wall.count() : 0.) << " events/s)\n"
+              << "  fit time         " << summary.recoSeconds << " core-s -> "
+              << std::setprecision(1)
+              << (summary.recoSeconds > 0. ? summary.fitted / summary.recoSeconds : 0.)
+              << " reconstructions/s/core\n";
+
+    if (summary.withTruth > 0) {
+        const char* axes[3] = { "x", "y", "z" };
+        for (int k = 0; k < 3; ++k) {
+            double mean = 0., rms = 0.;
+            meanRms(summary.sum[k], summary.sum2[k], summary.withTruth, mean, rms);
+            std::cout << "  vertex " << axes[k] << " residual  mean " << std::setw(8) << mean
+                      << " mm, RMS " << std::setw(8) << rms << " mm\n";
+        }
+    } else {
+        std::cout << "  (no truth columns; residuals not computed)\n";
+    }
+    if (summary.withEnergy > 0) {
+        double mean = 0., rms = 0.;
+        meanRms(summary.energySum, summary.energySum2, summary.withEnergy, mean, rms);
+        std::cout << std::setprecision(3)
+                  << "  E_rec / nu_energy  mean " << mean << ", RMS " << rms << '\n';
+    }
+    std::cout << std::defaultfloat << std::flush;
+
+    return failed ? 1 : 0;
+}
@@ -5,14 +5,31 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
+#include "MemoryMonitor.hh"
+#include "StackingAction.hh"
+#include "TrackingAction.hh"
 
 namespace ToyLArTPC {
 
 void ActionInitialization::Build() const
 {
+    auto eventAction = new EventAction();
+
     SetUserAction(new PrimaryGeneratorAction());
-    SetUserAction(new RunAction());
-    SetUserAction(new EventAction());
+    SetUserAction(new RunAction(eventAction));
+    SetUserAction(eventAction);
+
+    if (MemoryMonitor::IsEnabled()) {
+        SetUserAction(new StackingAction());
+    }
+
+    if (fVis.enabled) {
+        // With detected photons only, the cap applies after the undetected
+        // ones are pruned, or it would fill up with photons then deleted
+        SetUserAction(new TrackingAction(fVis.photonStride,
+                                         fVis.detectedOnly ? 0 : fVis.maxPhotons));
+        eventAction->SetKeepDetectedPhotonsOnly(fVis.detectedOnly, fVis.maxPhotons);
+    }
 }
 
 } // namespace ToyLArTPC
@@ -0,0 +1,200 @@
+/// \file BackgroundLibrary.cc
+/// \brief Implementation of the ToyLArTPC::BackgroundLibrary class.
+
+#include "BackgroundLibrary.hh"
+#include "DetectorParameters.hh"
+#include "RandomStreams.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace {
+
+constexpr char          kMagic[8] = { 'T', 'L', 'T', 'A', 'R', '3', '9', 'L' };
+constexpr std::uint32_t kVersion  = 1;
+
+/// Offset of the entry count in the header.
+constexpr long kEntryCountOffset = sizeof(kMagic) + 2 * sizeof(std::uint32_t);
+
+constexpr G4int kNTiles = DetectorParameters::kNTiles;
+
+/// Specific activity of Ar-39 in atmospheric argon and the LAr density.
+constexpr G4double kAr39ActivityPerKg = 1.01;      // Bq/kg
+constexpr G4double kLArDensity        = 1.396e-6;  // kg/mm3
+
+} // anonymous namespace
+
+std::FILE*    BackgroundLibrary::fgOutput   = nullptr;
+std::uint64_t BackgroundLibrary::fgRecorded = 0;
+std::mutex    BackgroundLibrary::fgMutex;
+
+std::vector<std::uint64_t> BackgroundLibrary::fgOffsets;
+std::vector<G4float>       BackgroundLibrary::fgHitTimes;
+std::vector<G4int>         BackgroundLibrary::fgHitTiles;
+std::vector<G4int>         BackgroundLibrary::fgDenseCounts;
+std::vector<G4float>       BackgroundLibrary::fgLastTime;
+G4double                   BackgroundLibrary::fgTail = 0.;
+
+G4double BackgroundLibrary::fgRate   = BackgroundLibrary::GetDefaultRate();
+G4double BackgroundLibrary::fgWindow = 10. * us;
+
+G4double BackgroundLibrary::GetDefaultRate()
+{
+    const G4double volume = DetectorParameters::kTpcX
+                          * DetectorParameters::kTpcY
+                          * DetectorParameters::kTpcZ;   // mm3
+    return kAr39ActivityPerKg * kLArDensity * volume;
+}
+
+void BackgroundLibrary::StartRecording(const std::string& file)
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+
+    fgOutput = std::fopen(file.c_str(), "wb");
+    if (!fgOutput) {
+        throw std::runtime_error("BackgroundLibrary: cannot open " + file);
+    }
+    std::setvbuf(fgOutput, nullptr, _IOFBF, 1 << 20);
+    fgRecorded = 0;
+
+    const std::uint32_t nTiles = kNTiles;
+    std::fwrite(kMagic, sizeof(kMagic), 1, fgOutput);
+    std::fwrite(&kVersion, sizeof(kVersion), 1, fgOutput);
+    std::fwrite(&nTiles, sizeof(nTiles), 1, fgOutput);
+    std::fwrite(&fgRecorded, sizeof(fgRecorded), 1, fgOutput);
+}
+
+void BackgroundLibrary::Record(const PhotonHitsCollection& hits, G4double t0)
+{
+    struct StoredHit { G4float time; std::int32_t tile; };
+
+    // Convert outside the lock; only the write is serialized
+    const auto nHits = hits.entries();
+    std::vector<StoredHit> stored;
+    stored.reserve(nHits);
+    for (std::size_t i = 0; i < nHits; ++i) {
+        stored.push_back({ static_cast<G4float>(hits[i]->GetTime() - t0),
+                           hits[i]->GetTileID() });
+    }
+    const std::uint32_t n = static_cast<std::uint32_t>(stored.size());
+
+    std::lock_guard<std::mutex> lock(fgMutex);
+    std::fwrite(&n, sizeof(n), 1, fgOutput);
+    std::fwrite(stored.data(), sizeof(StoredHit), stored.size(), fgOutput);
+    ++fgRecorded;
+}
+
+void BackgroundLibrary::FinishRecording()
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    if (!fgOutput) return;
+
+    std::fseek(fgOutput, kEntryCountOffset, SEEK_SET);
+    std::fwrite(&fgRecorded, sizeof(fgRecorded), 1, fgOutput);
+    std::fclose(fgOutput);
+    fgOutput = nullptr;
+
+    G4cout << "BackgroundLibrary: recorded " << fgRecorded << " decays" << G4endl;
+}
+
+void BackgroundLibrary::Load(const std::string& file)
+{
+    std::FILE* in = std::fopen(file.c_str(), "rb");
+    if (!in) {
+        throw std::runtime_error("BackgroundLibrary: cannot open " + file);
+    }
+
+    char magic[sizeof(kMagic)] = {};
+    std::uint32_t version = 0, nTiles = 0;
+    std::uint64_t nEntries = 0;
+    const bool headerOK =
+        std::fread(magic, sizeof(magic), 1, in) == 1
+        && std::fread(&version, sizeof(version), 1, in) == 1
+        && std::fread(&nTiles, sizeof(nTiles), 1, in) == 1
+        && std::fread(&nEntries, sizeof(nEntries), 1, in) == 1
+        && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0
+        && version == kVersion
+        && nTiles == static_cast<std::uint32_t>(kNTiles);
+    if (!headerOK || nEntries == 0) {
+        std::fclose(in);
+        throw std::runtime_error(
+            "BackgroundLibrary: " + file + " is not a usable Ar-39 library");
+    }
+
+    fgOffsets.assign(1, 0);
+    fgHitTimes.clear();
+    fgHitTiles.clear();
+    fgDenseCounts.assign(nEntries * kNTiles, 0);
+    fgLastTime.assign(nEntries, 0.f);
+    fgTail = 0.;
+
+    struct StoredHit { G4float time; std::int32_t tile; };
+    std::vector<StoredHit> stored;
+    for (std::uint64_t entry = 0; entry < nEntries; ++entry) {
+        std::uint32_t n = 0;
+        if (std::fread(&n, sizeof(n), 1, in) != 1) {
+            std::fclose(in);
+            fgOffsets.clear();
+            throw std::runtime_error("BackgroundLibrary: truncated " + file);
+        }
+        stored.resize(n);
+        if (std::fread(stored.data(), sizeof(StoredHit), n, in) != n) {
+            std::fclose(in);
+            fgOffsets.clear();
+            throw std::runtime_error("BackgroundLibrary: truncated " + file);
+        }
+
+        G4int* row = &fgDenseCounts[entry * kNTiles];
+        for (const auto& hit : stored) {
+            if (hit.tile < 0 || hit.tile >= kNTiles) continue;
+            fgHitTimes.push_back(hit.time);
+            fgHitTiles.push_back(hit.tile);
+            ++row[hit.tile];
+            fgLastTime[entry] = std::max(fgLastTime[entry], hit.time);
+        }
+        fgOffsets.push_back(fgHitTimes.size());
+        fgTail = std::max(fgTail, static_cast<G4double>(fgLastTime[entry]));
+    }
+    std::fclose(in);
+
+    G4cout << "BackgroundLibrary: loaded " << nEntries << " Ar-39 decays ("
+           << fgHitTimes.size() << " photons) from " << file << G4endl;
+}
+
+G4int BackgroundLibrary::Overlay(G4double t0, std::vector<G4int>& counts)
+{
+    const std::size_t nEntries = fgOffsets.size() - 1;
+    const G4double    span     = fgTail + fgWindow;
+    const G4double    windowEnd = t0 + fgWindow;
+    G4int* out = counts.data();
+
+    auto& random = RandomStreams::Get(RandomStreams::kBackground);
+    const G4int nDecays = static_cast<G4int>(random.Poisson(fgRate / s * span));
+    for (G4int d = 0; d < nDecays; ++d) {
+        const G4double    td    = t0 - fgTail + random.Flat() * span;
+        const std::size_t entry = std::min(
+            static_cast<std::size_t>(random.Flat() * nEntries), nEntries - 1);
+
+        if (td >= t0 && td + fgLastTime[entry] < windowEnd) {
+            // All light inside the window: add the whole count row
+            const G4int* row = &fgDenseCounts[entry * kNTiles];
+            for (G4int tile = 0; tile < kNTiles; ++tile) {
+                out[tile] += row[tile];
+            }
+        } else {
+            // Straddles an edge of the window: keep only photons inside it
+            for (auto i = fgOffsets[entry]; i < fgOffsets[entry + 1]; ++i) {
+                const G4double t = td + fgHitTimes[i];
+                if (t >= t0 && t < windowEnd) ++out[fgHitTiles[i]];
+            }
+        }
+    }
+    return nDecays;
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,213 @@
+/// \file BurstReadout.cc
+/// \brief Implementation of the ToyLArTPC::BurstReadout class.
+
+#include "BurstReadout.hh"
+#include "DetectorParameters.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace {
+
+constexpr char          kMagic[8] = { 'T', 'L', 'T', 'B', 'U', 'R', 'S', 'T' };
+constexpr std::uint32_t kVersion  = 1;
+
+/// Offset of the record count in the header.
+constexpr long kRecordCountOffset = sizeof(kMagic) + 2 * sizeof(std::uint32_t);
+
+using Head = std::pair<G4double, G4int>;   // (time of next hit, event ID)
+
+} // anonymous namespace
+
+std::string BurstReadout::fgOutputFile;
+std::string BurstReadout::fgProfileFile;
+G4double    BurstReadout::fgDuration = 10. * s;
+G4int       BurstReadout::fgWindow   = 64;
+
+std::vector<G4double> BurstReadout::fgTimes;
+std::vector<char>     BurstReadout::fgFinished;
+G4int                 BurstReadout::fgLowestUnfinished = 0;
+
+std::mutex                   BurstReadout::fgMutex;
+std::condition_variable      BurstReadout::fgWindowMoved;
+std::map<G4int, BurstReadout::Run> BurstReadout::fgRuns;
+std::vector<Head>            BurstReadout::fgHeads;
+std::FILE*                   BurstReadout::fgFile    = nullptr;
+std::uint64_t                BurstReadout::fgRecords = 0;
+
+void BurstReadout::Configure(const std::string& outputFile, G4double duration,
+                             const std::string& profileFile, G4int window)
+{
+    fgOutputFile  = outputFile;
+    fgDuration    = duration;
+    fgProfileFile = profileFile;
+    fgWindow      = std::max(window, 1);
+}
+
+std::vector<G4double> BurstReadout::SampleTimes(G4int nEvents)
+{
+    // --- Tabulate the luminosity profile ---
+    std::vector<G4double> t, rate;
+    if (!fgProfileFile.empty()) {
+        std::ifstream in(fgProfileFile);
+        G4double ts = 0., r = 0.;
+        while (in >> ts >> r) {
+            t.push_back(ts * s);
+            rate.push_back(std::max(r, 0.));
+        }
+        if (t.size() < 2) {
+            throw std::runtime_error(
+                "BurstReadout: need at least two points in " + fgProfileFile);
+        }
+    } else {
+        // Fast rise (accretion) followed by exponential cooling
+        const G4double riseTime = 50. * ms;
+        const G4double coolTime = 3. * s;
+        const G4int    nPoints  = 2001;
+        for (G4int i = 0; i < nPoints; ++i) {
+            const G4double ti = fgDuration * i / (nPoints - 1);
+            t.push_back(ti);
+            rate.push_back((1. - std::exp(-ti / riseTime)) * std::exp(-ti / coolTime));
+        }
+    }
+
+    // Cumulative distribution (trapezoidal rule)
+    std::vector<G4double> cdf(t.size(), 0.);
+    for (std::size_t i = 1; i < t.size(); ++i) {
+        cdf[i] = cdf[i - 1] + 0.5 * (rate[i] + rate[i - 1]) * (t[i] - t[i - 1]);
+    }
+
+    // --- Invert the CDF for sorted uniforms, so times come out ordered ---
+    std::vector<G4double> u(static_cast<std::size_t>(nEvents));
+    for (auto& ui : u) ui = G4UniformRand() * cdf.back();
+    std::sort(u.begin(), u.end());
+
+    std::vector<G4double> times(u.size());
+    std::size_t seg = 1;
+    for (std::size_t i = 0; i < u.size(); ++i) {
+        while (seg + 1 < cdf.size() && cdf[seg] < u[i]) ++seg;
+        const G4double width = cdf[seg] - cdf[seg - 1];
+        const G4double frac  = (width > 0.) ? (u[i] - cdf[seg - 1]) / width : 0.;
+        times[i] = t[seg - 1] + frac * (t[seg] - t[seg - 1]);
+    }
+    return times;
+}
+
+void BurstReadout::Start(G4int nEvents)
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+
+    fgTimes = SampleTimes(nEvents);
+    fgFinished.assign(fgTimes.size(), 0);
+    fgLowestUnfinished = 0;
+    fgRuns.clear();
+    fgHeads.clear();
+    fgRecords = 0;
+
+    fgFile = std::fopen(fgOutputFile.c_str(), "wb");
+    if (!fgFile) {
+        throw std::runtime_error("BurstReadout: cannot open " + fgOutputFile);
+    }
+    std::setvbuf(fgFile, nullptr, _IOFBF, 1 << 20);
+    const std::uint32_t nTiles = DetectorParameters::kNTiles;
+    std::fwrite(kMagic, sizeof(kMagic), 1, fgFile);
+    std::fwrite(&kVersion, sizeof(kVersion), 1, fgFile);
+    std::fwrite(&nTiles, sizeof(nTiles), 1, fgFile);
+    std::fwrite(&fgRecords, sizeof(fgRecords), 1, fgFile);
+
+    G4cout << "BurstReadout: " << nEvents << " interactions over "
+           << (fgTimes.empty() ? 0. : fgTimes.back() / s) << " s -> "
+           << fgOutputFile << G4endl;
+}
+
+G4double BurstReadout::GetInteractionTime(G4int eventID)
+{
+    return fgTimes.at(static_cast<std::size_t>(eventID));
+}
+
+void BurstReadout::WaitForWindow(G4int eventID)
+{
+    std::unique_lock<std::mutex> lock(fgMutex);
+    fgWindowMoved.wait(lock, [eventID] {
+        return eventID < fgLowestUnfinished + fgWindow;
+    });
+}
+
+void BurstReadout::Submit(G4int eventID, std::vector<Record>& hits)
+{
+    std::sort(hits.begin(), hits.end(),
+              [](const Record& a, const Record& b) { return a.time < b.time; });
+
+    {
+        std::lock_guard<std::mutex> lock(fgMutex);
+
+        if (!hits.empty()) {
+            auto& run = fgRuns[eventID];
+            run.hits.swap(hits);
+            fgHeads.emplace_back(run.hits.front().time, eventID);
+            std::push_heap(fgHeads.begin(), fgHeads.end(), std::greater<Head>());
+        }
+
+        fgFinished.at(static_cast<std::size_t>(eventID)) = 1;
+        const auto nEvents = static_cast<G4int>(fgFinished.size());
+        while (fgLowestUnfinished < nEvents && fgFinished[fgLowestUnfinished]) {
+            ++fgLowestUnfinished;
+        }
+
+        // Unfinished events start no earlier than the lowest one among them
+        const G4double watermark = (fgLowestUnfinished < nEvents)
+            ? fgTimes[fgLowestUnfinished]
+            : std::numeric_limits<G4double>::infinity();
+        Drain(watermark);
+    }
+    hits.clear();
+    fgWindowMoved.notify_all();
+}
+
+void BurstReadout::Drain(G4double watermark)
+{
+    while (!fgHeads.empty() && fgHeads.front().first < watermark) {
+        std::pop_heap(fgHeads.begin(), fgHeads.end(), std::greater<Head>());
+        const G4int eventID = fgHeads.back().second;
+        fgHeads.pop_back();
+
+        auto it = fgRuns.find(eventID);
+        auto& run = it->second;
+        std::fwrite(&run.hits[run.next], sizeof(Record), 1, fgFile);
+        ++fgRecords;
+
+        if (++run.next < run.hits.size()) {
+            fgHeads.emplace_back(run.hits[run.next].time, eventID);
+            std::push_heap(fgHeads.begin(), fgHeads.end(), std::greater<Head>());
+        } else {
+            fgRuns.erase(it);
+        }
+    }
+}
+
+void BurstReadout::Finish()
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    if (!fgFile) return;
+
+    Drain(std::numeric_limits<G4double>::infinity());
+
+    std::fseek(fgFile, kRecordCountOffset, SEEK_SET);
+    std::fwrite(&fgRecords, sizeof(fgRecords), 1, fgFile);
+    std::fclose(fgFile);
+    fgFile = nullptr;
+
+    G4cout << "BurstReadout: wrote " << fgRecords << " time-ordered hits to "
+           << fgOutputFile << G4endl;
+}
+
+} // namespace ToyLArTPC
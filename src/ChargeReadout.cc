@@ -0,0 +1,219 @@
+/// \file ChargeReadout.cc
+/// \brief Implementation of the ToyLArTPC::ChargeReadout class.
+
+#include "ChargeReadout.hh"
+#include "DetectorParameters.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace ToyLArTPC {
+
+namespace DP = DetectorParameters;
+
+namespace {
+
+/// Most cells a cluster may cover along one axis (3 sigma each way).
+/// Wider clusters keep the cells around their mean.
+constexpr G4int kMaxSpread = 64;
+
+/// One cell contribution before merging; key = plane | channel | tick.
+struct Deposit {
+    std::uint64_t key;
+    G4float       charge;
+};
+
+inline std::uint64_t MakeKey(G4int plane, G4int channel, G4int tick)
+{
+    return (static_cast<std::uint64_t>(plane) << 63)
+         | (static_cast<std::uint64_t>(channel) << 32)
+         | static_cast<std::uint32_t>(tick);
+}
+
+/// Per-thread scratch arrays, grown to the largest event seen.
+struct Scratch {
+    std::vector<G4float> arrival;     ///< Arrival time after t0 [ns]
+    std::vector<G4float> sigmaT;      ///< Transverse spread [mm]
+    std::vector<G4float> sigmaTime;   ///< Longitudinal spread [ns]
+    std::vector<G4float> electrons;   ///< After attachment
+    std::vector<Deposit> deposits;
+};
+
+thread_local Scratch tScratch;
+
+/// Drift kernel: arrival time, diffusion widths and surviving electrons
+/// of n clusters.
+void Drift(std::size_t n, const G4float* __restrict x, const G4float* __restrict t,
+           const G4float* __restrict ne, G4float t0, G4float invLifetime,
+           G4float* __restrict arrival, G4float* __restrict sigmaT,
+           G4float* __restrict sigmaTime, G4float* __restrict out)
+{
+    const G4float halfX  = 0.5f * static_cast<G4float>(DP::kTpcX);
+    const G4float invV   = 1.f / static_cast<G4float>(DP::kDriftVelocity);
+    const G4float twoDL  = 2.f * static_cast<G4float>(DP::kDiffusionL);
+    const G4float twoDT  = 2.f * static_cast<G4float>(DP::kDiffusionT);
+
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        const G4float distance = std::max(0.f, halfX - std::fabs(x[i]));
+        const G4float drift    = distance * invV;
+        arrival[i]   = (t[i] - t0) + drift;
+        sigmaT[i]    = std::sqrt(twoDT * drift);
+        sigmaTime[i] = std::sqrt(twoDL * drift) * invV;
+        out[i]       = ne[i] * std::exp(-drift * invLifetime);
+    }
+}
+
+/// Projection kernel: fractions of a Gaussian (mean mu, width sigma) in the
+/// cells [origin + k * width, origin + (k + 1) * width), k in [0, nCells).
+/// Writes the fractions of cells first .. first + count - 1 to `weight`,
+/// normalized to the whole cluster: charge beyond the detector edge or
+/// outside the kMaxSpread cells kept is shared among those kept.
+G4int Spread(G4float mu, G4float sigma, G4float origin, G4float width, G4int nCells,
+             G4int& first, G4float* __restrict weight)
+{
+    const G4float u = (mu - origin) / width;
+    if (sigma < 1.e-3f * width) {
+        // Narrower than a cell: all of it in the cell of the mean
+        first = std::clamp(static_cast<G4int>(std::floor(u)), 0, nCells - 1);
+        weight[0] = 1.f;
+        return 1;
+    }
+    const G4float reach = 3.f * sigma / width;
+    first = std::clamp(static_cast<G4int>(std::floor(u - reach)), 0, nCells - 1);
+    G4int last = std::clamp(static_cast<G4int>(std::floor(u + reach)), 0, nCells - 1);
+    if (last - first + 1 > kMaxSpread) {
+        // Wider than the buffers: keep the cells centred on the mean
+        const G4int centre = std::clamp(static_cast<G4int>(std::floor(u)), first, last);
+        first = std::clamp(centre - kMaxSpread / 2, first, last - kMaxSpread + 1);
+        last  = first + kMaxSpread - 1;
+    }
+    const G4int count = last - first + 1;
+
+    G4float edge[kMaxSpread + 1];
+    const G4float scale = width / (sigma * std::sqrt(2.f));
+#pragma omp simd
+    for (G4int k = 0; k <= count; ++k) {
+        edge[k] = std::erf((static_cast<G4float>(first + k) - u) * scale);
+    }
+    G4float sum = 0.f;
+#pragma omp simd reduction(+ : sum)
+    for (G4int k = 0; k < count; ++k) {
+        weight[k] = 0.5f * (edge[k + 1] - edge[k]);
+        sum += weight[k];
+    }
+    if (!(sum > 0.f)) {
+        first = std::clamp(static_cast<G4int>(std::floor(u)), 0, nCells - 1);
+        weight[0] = 1.f;
+        return 1;
+    }
+    const G4float norm = 1.f / sum;
+#pragma omp simd
+    for (G4int k = 0; k < count; ++k) weight[k] *= norm;
+    return count;
+}
+
+} // anonymous namespace
+
+G4bool         ChargeReadout::fgEnabled = false;
+ChargeSettings ChargeReadout::fgSettings;
+
+void ChargeReadout::Configure(const ChargeSettings& settings)
+{
+    fgSettings = settings;
+    fgEnabled  = true;
+
+    // Widest clusters: charge drifting the full half-width of the TPC
+    const G4double drift     = 0.5 * DP::kTpcX / DP::kDriftVelocity;
+    const G4double sigmaT    = std::sqrt(2. * DP::kDiffusionT * drift);
+    const G4double sigmaTime = std::sqrt(2. * DP::kDiffusionL * drift) / DP::kDriftVelocity;
+    const G4double cells     = 6. * std::max(sigmaT / settings.pitch, sigmaTime / settings.tick);
+    if (cells > kMaxSpread) {
+        G4cout << "ChargeReadout: long drifts spread over up to " << std::ceil(cells)
+               << " cells; only the " << kMaxSpread << " around the mean are kept" << G4endl;
+    }
+}
+
+G4int ChargeReadout::GetNumberOfChannels()
+{
+    const auto nY = static_cast<G4int>(std::ceil(DP::kTpcY / fgSettings.pitch));
+    const auto nZ = static_cast<G4int>(std::ceil(DP::kTpcZ / fgSettings.pitch));
+    return fgSettings.wires ? nZ : nY * nZ;
+}
+
+void ChargeReadout::Process(const ChargeClusters& clusters, G4double t0, ChargeImage& image)
+{
+    image.clear();
+    const std::size_t n = clusters.size();
+    if (n == 0) return;
+
+    auto& scratch = tScratch;
+    scratch.arrival.resize(n);
+    scratch.sigmaT.resize(n);
+    scratch.sigmaTime.resize(n);
+    scratch.electrons.resize(n);
+    scratch.deposits.clear();
+
+    Drift(n, clusters.x.data(), clusters.t.data(), clusters.electrons.data(),
+          static_cast<G4float>(t0), static_cast<G4float>(1. / fgSettings.lifetime),
+          scratch.arrival.data(), scratch.sigmaT.data(), scratch.sigmaTime.data(),
+          scratch.electrons.data());
+
+    // --- Share every cluster among the cells within 3 sigma ---
+    const auto pitch = static_cast<G4float>(fgSettings.pitch);
+    const auto tick  = static_cast<G4float>(fgSettings.tick);
+    const auto nY    = static_cast<G4int>(std::ceil(DP::kTpcY / fgSettings.pitch));
+    const auto nZ    = static_cast<G4int>(std::ceil(DP::kTpcZ / fgSettings.pitch));
+    const auto y0    = static_cast<G4float>(-0.5 * DP::kTpcY);
+    const auto z0    = static_cast<G4float>(-0.5 * DP::kTpcZ);
+    const G4int maxTick = std::numeric_limits<G4int>::max();
+
+    G4float wy[kMaxSpread], wz[kMaxSpread], wt[kMaxSpread];
+    for (std::size_t i = 0; i < n; ++i) {
+        const G4float q = scratch.electrons[i];
+        if (q <= 0.f) continue;
+        const G4int plane = (clusters.x[i] >= 0.f) ? 1 : 0;
+
+        G4int firstY = 0, firstZ = 0, firstT = 0;
+        G4int countY = 1;
+        wy[0] = 1.f;
+        if (!fgSettings.wires) {
+            countY = Spread(clusters.y[i], scratch.sigmaT[i], y0, pitch, nY, firstY, wy);
+        }
+        const G4int countZ = Spread(clusters.z[i], scratch.sigmaT[i], z0, pitch, nZ, firstZ, wz);
+        const G4int countT = Spread(scratch.arrival[i], scratch.sigmaTime[i], 0.f, tick,
+                                    maxTick, firstT, wt);
+
+        for (G4int a = 0; a < countY; ++a) {
+            for (G4int b = 0; b < countZ; ++b) {
+                const G4float qyz = q * wy[a] * wz[b];
+                const G4int channel = fgSettings.wires
+                    ? firstZ + b : (firstY + a) * nZ + firstZ + b;
+                for (G4int c = 0; c < countT; ++c) {
+                    scratch.deposits.push_back({ MakeKey(plane, channel, firstT + c),
+                                                 qyz * wt[c] });
+                }
+            }
+        }
+    }
+
+    // --- Merge deposits in the same cell and zero-suppress ---
+    auto& deposits = scratch.deposits;
+    std::sort(deposits.begin(), deposits.end(),
+              [](const Deposit& a, const Deposit& b) { return a.key < b.key; });
+    const auto threshold = static_cast<G4float>(fgSettings.threshold);
+    for (std::size_t i = 0; i < deposits.size();) {
+        const std::uint64_t key = deposits[i].key;
+        G4float sum = 0.f;
+        for (; i < deposits.size() && deposits[i].key == key; ++i) sum += deposits[i].charge;
+        if (sum < threshold) continue;
+        image.plane.push_back(static_cast<G4int>(key >> 63));
+        image.channel.push_back(static_cast<G4int>((key >> 32) & 0x7FFFFFFFu));
+        image.tick.push_back(static_cast<G4int>(key & 0xFFFFFFFFu));
+        image.charge.push_back(sum);
+    }
+}
+
+} // namespace ToyLArTPC
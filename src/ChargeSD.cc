@@ -0,0 +1,68 @@
+/// \file ChargeSD.cc
+/// \brief Implementation of the ToyLArTPC::ChargeSD class.
+
+#include "ChargeSD.hh"
+#include "DetectorParameters.hh"
+
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ToyLArTPC {
+
+namespace {
+
+/// Below about 1 MeV/cm the Box model is not valid (and turns negative).
+constexpr G4double kMinDEdx = 1.;   // MeV/cm
+
+/// Fraction of the ionization surviving recombination (Box model).
+G4double Recombination(G4double dEdx)
+{
+    using namespace DetectorParameters;
+    const G4double xi = kBoxBeta * std::max(dEdx, kMinDEdx)
+                      / (kLArDensityGcm3 * kDriftField);
+    return std::log(kBoxAlpha + xi) / xi;
+}
+
+} // anonymous namespace
+
+G4bool ChargeSD::fgEnergyDepositTruth = false;
+
+ChargeSD::ChargeSD(const G4String& name)
+    : G4VSensitiveDetector(name)
+{}
+
+void ChargeSD::Initialize(G4HCofThisEvent* /*hce*/)
+{
+    fClusters.clear();
+    fEnergyDeposit = 0.;
+}
+
+G4bool ChargeSD::ProcessHits(G4Step* step, G4TouchableHistory* /*history*/)
+{
+    // Optical photons and neutrals deposit nothing: leave at once
+    const G4double total = step->GetTotalEnergyDeposit();
+    if (total <= 0.) return false;
+    fEnergyDeposit += total;
+
+    const G4double edep = total - step->GetNonIonizingEnergyDeposit();
+    if (edep <= 0. || !ChargeReadout::IsEnabled()) return true;
+
+    const G4double length = step->GetStepLength();
+    const G4double dEdx   = (length > 0.) ? (edep / MeV) / (length / cm) : kMinDEdx;
+    const G4double electrons =
+        edep * Recombination(dEdx) / (DetectorParameters::kIonizationEnergy * MeV);
+
+    const auto pre  = step->GetPreStepPoint();
+    const auto post = step->GetPostStepPoint();
+    const auto mid  = 0.5 * (pre->GetPosition() + post->GetPosition());
+    const G4double time = 0.5 * (pre->GetGlobalTime() + post->GetGlobalTime());
+    fClusters.push_back(static_cast<G4float>(mid.x()), static_cast<G4float>(mid.y()),
+                        static_cast<G4float>(mid.z()), static_cast<G4float>(time),
+                        static_cast<G4float>(electrons));
+    return true;
+}
+
+} // namespace ToyLArTPC
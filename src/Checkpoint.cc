@@ -0,0 +1,143 @@
+/// \file Checkpoint.cc
+/// \brief Implementation of the ToyLArTPC::Checkpoint class.
+
+#include "Checkpoint.hh"
+#include "PrimaryGeneratorAction.hh"
+
+#include "Randomize.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace ToyLArTPC {
+
+namespace {
+
+void WriteState(std::ostream& os, const std::vector<unsigned long>& state)
+{
+    os << state.size();
+    for (auto word : state) os << ' ' << word;
+}
+
+bool ReadState(std::istream& is, std::vector<unsigned long>& state)
+{
+    std::size_t n = 0;
+    if (!(is >> n)) return false;
+    state.resize(n);
+    for (auto& word : state) {
+        if (!(is >> word)) return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+std::mutex       Checkpoint::fgMutex;
+std::string      Checkpoint::fgPath;
+G4int            Checkpoint::fgInterval = 0;
+CheckpointRecord Checkpoint::fgBase;
+CheckpointRecord Checkpoint::fgCurrent;
+
+void Checkpoint::Start(const std::string& path, G4int interval,
+                       const CheckpointRecord& base)
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    fgPath     = path;
+    fgInterval = interval;
+    fgBase     = base;
+    fgCurrent  = base;
+    fgCurrent.threads.clear();
+    fgCurrent.masterRandomState = G4Random::getTheEngine()->put();
+}
+
+void Checkpoint::RecordFlush(G4int threadID, G4int flushed, G4int lastEventID)
+{
+    // Read the calling thread's engine before taking the lock.
+    auto randomState = G4Random::getTheEngine()->put();
+
+    std::lock_guard<std::mutex> lock(fgMutex);
+    auto& thread = fgCurrent.threads[threadID];
+    thread.flushed     = flushed;
+    thread.lastEventID = lastEventID;
+    thread.randomState = std::move(randomState);
+
+    fgCurrent.completed = fgBase.completed;
+    for (const auto& entry : fgCurrent.threads) {
+        fgCurrent.completed += entry.second.flushed;
+    }
+    fgCurrent.cursor = PrimaryGeneratorAction::GetNextEvent();
+
+    Write(fgCurrent);
+}
+
+void Checkpoint::Write(const CheckpointRecord& record)
+{
+    const std::string tmpPath = fgPath + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        out << "# ToyLArTPC checkpoint\n"
+            << "total "     << record.total     << '\n'
+            << "completed " << record.completed << '\n'
+            << "cursor "    << record.cursor    << '\n'
+            << "segment "   << record.segment   << '\n'
+            << "output "    << record.output    << '\n'
+            << "seed "      << record.seed      << '\n'
+            << "master ";
+        WriteState(out, record.masterRandomState);
+        out << '\n';
+        for (const auto& entry : record.threads) {
+            const auto& thread = entry.second;
+            out << "thread " << entry.first << ' ' << thread.flushed
+                << ' ' << thread.lastEventID << ' ';
+            WriteState(out, thread.randomState);
+            out << '\n';
+        }
+        if (!out) {
+            G4cerr << "Checkpoint: cannot write " << tmpPath << G4endl;
+            return;
+        }
+    }
+    std::rename(tmpPath.c_str(), fgPath.c_str());
+}
+
+bool Checkpoint::Read(const std::string& path, CheckpointRecord& record)
+{
+    std::ifstream in(path);
+    if (!in) return false;
+
+    record = CheckpointRecord();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        bool ok = true;
+        if (key == "total") {
+            ok = static_cast<bool>(fields >> record.total);
+        } else if (key == "completed") {
+            ok = static_cast<bool>(fields >> record.completed);
+        } else if (key == "cursor") {
+            ok = static_cast<bool>(fields >> record.cursor);
+        } else if (key == "segment") {
+            ok = static_cast<bool>(fields >> record.segment);
+        } else if (key == "output") {
+            ok = static_cast<bool>(fields >> record.output);
+        } else if (key == "seed") {
+            ok = static_cast<bool>(fields >> record.seed);
+        } else if (key == "master") {
+            ok = ReadState(fields, record.masterRandomState);
+        } else if (key == "thread") {
+            G4int threadID = 0;
+            CheckpointRecord::ThreadState thread;
+            ok = (fields >> threadID >> thread.flushed >> thread.lastEventID)
+                 && ReadState(fields, thread.randomState);
+            record.threads[threadID] = thread;
+        }
+        if (!ok) return false;
+    }
+    return record.total > 0 && !record.output.empty();
+}
+
+} // namespace ToyLArTPC
@@ -2,6 +2,8 @@
 /// \brief Implementation of the ToyLArTPC::DetectorConstruction class.
 
 #include "DetectorConstruction.hh"
+#include "DetectorParameters.hh"
+#include "ChargeSD.hh"
 #include "PhotonSD.hh"
 
 #include "G4Box.hh"
@@ -11,16 +13,39 @@
 #include "G4PVPlacement.hh"
 #include "G4SDManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
 #include "G4VisAttributes.hh"
 
+#include <chrono>
+#include <sstream>
+
 namespace ToyLArTPC {
 
+using namespace DetectorParameters;
+
+G4double DetectorConstruction::fgConstructionTime = 0.;
+
 DetectorConstruction::DetectorConstruction(bool fullYield)
     : G4VUserDetectorConstruction(), fFullYield(fullYield)
 {}
 
+G4String DetectorConstruction::GetConfigurationKey() const
+{
+    std::ostringstream key;
+    key << "tpc=" << kTpcX << 'x' << kTpcY << 'x' << kTpcZ
+        << ";tile=" << kTileThickness << 'x' << kTileHeight << 'x' << kTileLength
+        << ";grid=" << kTileWalls << 'x' << kTileRows << 'x' << kTileCols
+        << ";rindex=" << kRefractiveIndex
+        << ";abslength=" << kAbsorptionLength
+        << ";rayleigh=" << kRayleighLength
+        << ";yield=" << (fFullYield ? kFullYieldPerMeV : kReducedYieldPerMeV);
+    return key.str();
+}
+
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {
+    const auto start = std::chrono::steady_clock::now();
+
     // --- Materials ---
     auto nist = G4NistManager::Instance();
     G4Material* worldMat = nist->FindOrBuildMaterial("G4_AIR");
@@ -36,15 +61,15 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     std::vector<G4double> photonEnergy = { 8.55 * eV, 9.69 * eV, 10.78 * eV };
 
     // Refractive index of LAr (~1.38 in VUV)
-    std::vector<G4double> rIndex = { 1.38, 1.38, 1.38 };
+    std::vector<G4double> rIndex(3, kRefractiveIndex);
     larMPT->AddProperty("RINDEX", photonEnergy, rIndex);
 
     // Absorption length (~60 cm for VUV in pure LAr)
-    std::vector<G4double> absLength = { 60. * cm, 60. * cm, 60. * cm };
+    std::vector<G4double> absLength(3, kAbsorptionLength);
     larMPT->AddProperty("ABSLENGTH", photonEnergy, absLength);
 
     // Rayleigh scattering length (~90 cm at 128 nm)
-    std::vector<G4double> rayleigh = { 90. * cm, 90. * cm, 90. * cm };
+    std::vector<G4double> rayleigh(3, kRayleighLength);
     larMPT->AddProperty("RAYLEIGH", photonEnergy, rayleigh);
 
     // Scintillation emission spectrum (single Gaussian-like peak at 128 nm)
@@ -54,7 +79,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
     // Scintillation yield: physical value is ~24 000 photons/MeV.
     // Use the full value for production runs, or 100× reduced for fast/visualization.
-    G4double scintYield = fFullYield ? 24000. / MeV : 240. / MeV;
+    G4double scintYield = (fFullYield ? kFullYieldPerMeV : kReducedYieldPerMeV) / MeV;
     larMPT->AddConstProperty("SCINTILLATIONYIELD", scintYield);
 
     // Resolution scale (statistical broadening; 1.0 = Poisson)
@@ -78,19 +103,20 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
         nullptr, G4ThreeVector(), logicWorld, "World", nullptr, false, 0, true);
 
     // --- LArTPC active volume ---
-    G4double tpcX = 2.0 * m;
-    G4double tpcY = 10.0 * m;
-    G4double tpcZ = 10.0 * m;
+    G4double tpcX = kTpcX;
+    G4double tpcY = kTpcY;
+    G4double tpcZ = kTpcZ;
     auto solidTPC = new G4Box("TPC", tpcX / 2, tpcY / 2, tpcZ / 2);
     auto logicTPC = new G4LogicalVolume(solidTPC, lAr, "TPC");
+    fTpcLogical = logicTPC;
     new G4PVPlacement(
         nullptr, G4ThreeVector(), logicTPC, "TPC", logicWorld, false, 0, true);
 
     // --- Photon detector tiles ---
     // Tile dimensions
-    G4double pdThick  = 1.0 * mm;    // X – thickness
-    G4double pdHeight = 10.0 * cm;   // Y – height
-    G4double pdLength = 1.0 * m;     // Z – length
+    G4double pdThick  = kTileThickness;   // X – thickness
+    G4double pdHeight = kTileHeight;      // Y – height
+    G4double pdLength = kTileLength;      // Z – length
 
     auto solidPD = new G4Box("PhotonDet",
                              pdThick / 2, pdHeight / 2, pdLength / 2);
@@ -103,41 +129,28 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     pdVis->SetForceSolid(true);
     fPhotonDetLogical->SetVisAttributes(pdVis);
 
-    // Grid layout: 5 rows (Y) × 5 columns (Z) = 25 tiles per wall
-    const G4int nRows = 5;
-    const G4int nCols = 5;
-
-    // Equal spacing across each face
-    // Y positions: divide tpcY into (nRows+1) gaps
-    // Z positions: divide tpcZ into (nCols+1) gaps
-    G4double ySpacing = tpcY / (nRows + 1);
-    G4double zSpacing = tpcZ / (nCols + 1);
-
-    // X position: flush against the inner TPC wall
-    // Tiles are inside the TPC, centered at ±(tpcX/2 - pdThick/2)
-    G4double xInner = tpcX / 2 - pdThick / 2;
-
-    G4int copyNo = 0;
-    for (G4int wall = 0; wall < 2; ++wall) {
-        G4double xPos = (wall == 0) ? -xInner : +xInner;
-
-        for (G4int row = 0; row < nRows; ++row) {
-            G4double yPos = -tpcY / 2 + (row + 1) * ySpacing;
-
-            for (G4int col = 0; col < nCols; ++col) {
-                G4double zPos = -tpcZ / 2 + (col + 1) * zSpacing;
-
-                new G4PVPlacement(
-                    nullptr,
-                    G4ThreeVector(xPos, yPos, zPos),
-                    fPhotonDetLogical,
-                    "PhotonDet",
-                    logicTPC,
-                    false,
-                    copyNo++,
-                    true);
-            }
-        }
+    // Grid layout: 5 rows (Y) × 5 columns (Z) = 25 tiles per wall,
+    // equally spaced across each face and flush against the inner TPC wall
+    // (see DetectorParameters::TileCentre).
+    for (G4int copyNo = 0; copyNo < kNTiles; ++copyNo) {
+        G4double xPos = 0., yPos = 0., zPos = 0.;
+        TileCentre(copyNo, xPos, yPos, zPos);
+
+        new G4PVPlacement(
+            nullptr,
+            G4ThreeVector(xPos, yPos, zPos),
+            fPhotonDetLogical,
+            "PhotonDet",
+            logicTPC,
+            false,
+            copyNo,
+            true);
+    }
+
+    if (G4Threading::IsMasterThread()) {
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        fgConstructionTime = elapsed.count();
     }
 
     return physWorld;
@@ -148,6 +161,13 @@ void DetectorConstruction::ConstructSDandField()
     auto photonSD = new PhotonSD("ToyLArTPC/PhotonSD", "PhotonHitsCollection");
     G4SDManager::GetSDMpointer()->AddNewDetector(photonSD);
     SetSensitiveDetector(fPhotonDetLogical, photonSD);
+
+    // Energy deposits (truth) and ionization charge, only when wanted:
+    // every step in the TPC would pay for it
+    if (!ChargeSD::IsNeeded()) return;
+    auto chargeSD = new ChargeSD("ToyLArTPC/ChargeSD");
+    G4SDManager::GetSDMpointer()->AddNewDetector(chargeSD);
+    SetSensitiveDetector(fTpcLogical, chargeSD);
 }
 
 } // namespace ToyLArTPC
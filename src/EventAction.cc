@@ -2,21 +2,80 @@
 /// \brief Implementation of the ToyLArTPC::EventAction class.
 
 #include "EventAction.hh"
+#include "BackgroundLibrary.hh"
+#include "BurstReadout.hh"
+#include "ChargeSD.hh"
+#include "Checkpoint.hh"
+#include "DetectorParameters.hh"
+#include "EventCost.hh"
+#include "EventInformation.hh"
+#include "MemoryMonitor.hh"
+#include "OutputSink.hh"
 #include "PhotonHit.hh"
+#include "PrecisionTarget.hh"
 #include "RunAction.hh"
+#include "RunAggregates.hh"
+#include "SharedMemoryStream.hh"
+#include "Trigger.hh"
+#include "WorkerInitialization.hh"
 
-#include "G4AnalysisManager.hh"
 #include "G4Event.hh"
 #include "G4HCofThisEvent.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4SDManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "G4TrajectoryContainer.hh"
+#include "G4VTrajectory.hh"
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 namespace ToyLArTPC {
 
-void EventAction::BeginOfEventAction(const G4Event* /*event*/)
+namespace {
+
+/// Remove the stored trajectories of optical photons that never reached a
+/// tile, keeping the trajectories of other particles and of the first
+/// `maxPhotons` detected photons (0 = all).
+void PruneUndetectedPhotons(const G4Event* event, const PhotonHitsCollection& hits,
+                            G4int maxPhotons)
 {
-    // Nothing needed at the start of the event
+    auto trajectories = event->GetTrajectoryContainer();
+    if (!trajectories) return;
+
+    std::unordered_set<G4int> detected;
+    const auto nHits = hits.entries();
+    for (std::size_t i = 0; i < nHits; ++i) {
+        detected.insert(hits[i]->GetTrackID());
+    }
+
+    auto vec = trajectories->GetVector();
+    G4int kept = 0;
+    auto undetected = [&detected, &kept, maxPhotons](G4VTrajectory* trajectory) {
+        if (trajectory->GetParticleName() != "opticalphoton") return false;
+        if (detected.count(trajectory->GetTrackID()) > 0
+            && (maxPhotons == 0 || kept < maxPhotons)) {
+            ++kept;
+            return false;
+        }
+        delete trajectory;
+        return true;
+    };
+    vec->erase(std::remove_if(vec->begin(), vec->end(), undetected), vec->end());
+}
+
+} // anonymous namespace
+
+void EventAction::BeginOfEventAction(const G4Event* event)
+{
+    fEventStart = WorkerInitialization::Now();
+
+    // Burst mode: do not run too far ahead of the slowest unfinished event
+    if (BurstReadout::IsEnabled()) {
+        BurstReadout::WaitForWindow(event->GetEventID());
+    }
 }
 
 void EventAction::EndOfEventAction(const G4Event* event)
@@ -29,11 +88,45 @@ void EventAction::EndOfEventAction(const G4Event* event)
 
     // Get the hits collection for this event
     auto hce = event->GetHCofThisEvent();
-    if (!hce) return;
+    auto hitsCollection = hce
+        ? static_cast<PhotonHitsCollection*>(hce->GetHC(fHCID))
+        : nullptr;
+
+    // Burst mode: every event must be handed over, even one without hits,
+    // or the time-ordered readout stalls
+    if (BurstReadout::IsEnabled()) {
+        fBurstHits.clear();
+        const auto nBurstHits = hitsCollection ? hitsCollection->entries() : 0;
+        for (std::size_t i = 0; i < nBurstHits; ++i) {
+            const auto hit = (*hitsCollection)[i];
+            fBurstHits.push_back({ hit->GetTime(), hit->GetTileID(), event->GetEventID() });
+        }
+        BurstReadout::Submit(event->GetEventID(), fBurstHits);
+    }
+
+    if (MemoryMonitor::IsEnabled()) {
+        MemoryMonitor::RecordEvent(event->GetEventID(),
+                                   hitsCollection ? hitsCollection->entries() : 0);
+    }
 
-    auto hitsCollection =
-        static_cast<PhotonHitsCollection*>(hce->GetHC(fHCID));
-    if (!hitsCollection) return;
+    if (EventCost::IsEnabled()) {
+        EventCost::EndEvent(event, hitsCollection ? hitsCollection->entries() : 0);
+    }
+
+    if (!hitsCollection) {
+        if (!RunAggregates::IsEnabled()) WriteTruthRow(event, 0, -1);
+        return;
+    }
+
+    // Ar-39 library production: every decay becomes one library entry
+    const G4double t0 = event->GetPrimaryVertex()->GetT0();
+    if (BackgroundLibrary::IsRecording()) {
+        BackgroundLibrary::Record(*hitsCollection, t0);
+    }
+
+    if (fDetectedPhotonsOnly) {
+        PruneUndetectedPhotons(event, *hitsCollection, fMaxDetectedPhotons);
+    }
 
     // Count photons per tile
     const G4int nTiles = RunAction::kNTiles;
@@ -47,13 +140,165 @@ void EventAction::EndOfEventAction(const G4Event* event)
         }
     }
 
-    // Fill the ntuple (ntuple id = 0)
-    auto analysisManager = G4AnalysisManager::Instance();
-    for (G4int col = 0; col < nTiles; ++col) {
-        analysisManager->FillNtupleIColumn(col, counts[col]);
+    // Arrival-time histogram of the simulated photons, relative to the vertex
+    if (RunAction::HasArrivalTimes()) {
+        fArrivalTimes.assign(DetectorParameters::kTimeBins, 0);
+        for (G4int i = 0; i < nHits; ++i) {
+            const G4double t = (*hitsCollection)[i]->GetTime() - t0;
+            ++fArrivalTimes[DetectorParameters::TimeBin(t / ns)];
+        }
+    }
+
+    // Ar-39 background falling into this event's readout window
+    if (BackgroundLibrary::IsLoaded()) {
+        BackgroundLibrary::Overlay(t0, counts);
+    }
+
+    // Online trigger: failing events are dropped or prescaled
+    G4int nFired = 0, total = 0;
+    const G4bool triggered = Trigger::Passes(counts, nFired, total);
+    const G4int  prescale  = Trigger::GetSettings().prescale;
+    G4int weight = 0;
+    if (triggered) {
+        weight = 1;
+    } else if (Trigger::KeepPrescaled()) {
+        weight = prescale;
+    }
+    // Live consumer: every kept event, whatever is written to disk
+    if (weight > 0 && SharedMemoryStream::IsEnabled()) {
+        SharedMemoryStream::Publish(event, counts, triggered, weight, total);
+    }
+
+    if (weight > 0 && PrecisionTarget::IsEnabled()) {
+        const auto vertex = event->GetPrimaryVertex()->GetPosition();
+        PrecisionTarget::Fill(counts, weight, vertex.x(), vertex.y(), vertex.z());
+    }
+
+    if (weight > 0 && RunAggregates::IsEnabled()) {
+        const auto vertex = event->GetPrimaryVertex()->GetPosition();
+        RunAggregates::Fill(counts, weight, vertex.x(), vertex.y(), vertex.z());
+        for (G4int i = 0; i < nHits; ++i) {
+            const G4double t = (*hitsCollection)[i]->GetTime() - t0;
+            RunAggregates::FillArrivalTime(t / ns, weight);
+        }
+    } else if (!RunAggregates::IsEnabled()) {
+        G4long countsEntry = -1;
+        if (weight > 0) {
+            countsEntry = fCountsRows++;
+            WriteRow(event, counts, triggered, weight, total);
+        }
+        WriteTruthRow(event, nHits, countsEntry);
+    }
+
+    ++fEventsProcessed;
+    fLastEventID = event->GetEventID();
+
+    // Periodic incremental flush, so a killed job keeps its completed events
+    if (Checkpoint::IsEnabled() && fEventsProcessed % Checkpoint::GetInterval() == 0) {
+        OutputSink::Instance()->Flush();
+        Checkpoint::RecordFlush(G4Threading::G4GetThreadId(),
+                                fEventsProcessed, fLastEventID);
     }
-    analysisManager->AddNtupleRow();
 }
 
-} // namespace ToyLArTPC
+void EventAction::WriteRow(const G4Event* event, const std::vector<G4int>& counts,
+                           G4bool triggered, G4int weight, G4int total)
+{
+    const G4int nTiles = RunAction::kNTiles;
+    auto sink = OutputSink::Instance();
+
+    const auto info = static_cast<const EventInformation*>(event->GetUserInformation());
+    const G4int eventID = info ? info->GetGlobalID() : event->GetEventID();
+    const G4int id = RunAction::kCountsNtuple;
 
+    // Fill the counts table (table id = kCountsNtuple)
+    G4int col = 0;
+    if (RunAction::IsSparseOutput()) {
+        fSparseTiles.clear();
+        fSparseCounts.clear();
+        for (G4int tile = 0; tile < nTiles; ++tile) {
+            if (counts[tile] > 0) {
+                fSparseTiles.push_back(tile);
+                fSparseCounts.push_back(counts[tile]);
+            }
+        }
+        sink->FillIColumn(id, col++, eventID);
+        sink->FillIColumn(id, col++, triggered ? 1 : 0);
+        sink->FillIColumn(id, col++, weight);
+        sink->FillIColumn(id, col++, static_cast<G4int>(fSparseTiles.size()));
+        sink->FillIColumn(id, col++, total);
+    } else {
+        for (; col < nTiles; ++col) {
+            sink->FillIColumn(id, col, counts[col]);
+        }
+        sink->FillIColumn(id, col++, eventID);
+        if (Trigger::IsEnabled()) {
+            sink->FillIColumn(id, col++, triggered ? 1 : 0);
+            sink->FillIColumn(id, col++, weight);
+        }
+    }
+
+    sink->AddRow(id);
+
+    if (ChargeReadout::IsEnabled()) {
+        WriteChargeRow(event);
+    }
+}
+
+void EventAction::WriteTruthRow(const G4Event* event, G4int nPhotons, G4long countsEntry)
+{
+    const auto info   = static_cast<const EventInformation*>(event->GetUserInformation());
+    const auto vertex = event->GetPrimaryVertex()->GetPosition();
+    const G4int eventID = info ? info->GetGlobalID() : event->GetEventID();
+    const G4int id = RunAction::kTruthNtuple;
+
+    // Fill the truth table (table id = kTruthNtuple)
+    auto sink = OutputSink::Instance();
+    sink->FillIColumn(id, 0, eventID);
+    sink->FillIColumn(id, 1, info ? info->GetMarleyIndex() : -1);
+    sink->FillDColumn(id, 2, info ? info->GetNuEnergy() : 0.);
+    sink->FillDColumn(id, 3, vertex.x());
+    sink->FillDColumn(id, 4, vertex.y());
+    sink->FillDColumn(id, 5, vertex.z());
+    sink->FillDColumn(id, 6, event->GetPrimaryVertex()->GetT0());
+    sink->FillIColumn(id, 7, info ? info->GetStratum() : 0);
+    sink->FillDColumn(id, 8, info ? info->GetStratumWeight() : 1.);
+    const auto chargeSD = GetChargeSD();
+    sink->FillDColumn(id, 9, chargeSD ? chargeSD->GetEnergyDeposit() : -1.);
+    sink->FillIColumn(id, 10, nPhotons);
+    sink->FillIColumn(id, 11, countsEntry >= 0 ? 1 : 0);
+    sink->FillDColumn(id, 12, WorkerInitialization::Now() - fEventStart);
+    sink->AddRow(id);
+
+    EventIndexEntry entry;
+    entry.event       = eventID;
+    entry.countsEntry = countsEntry;
+    entry.truthEntry  = fTruthRows++;
+    fIndexEntries.push_back(entry);
+}
+
+ChargeSD* EventAction::GetChargeSD()
+{
+    if (!fChargeSD && ChargeSD::IsNeeded()) {
+        fChargeSD = static_cast<ChargeSD*>(G4SDManager::GetSDMpointer()
+                        ->FindSensitiveDetector("ToyLArTPC/ChargeSD"));
+    }
+    return fChargeSD;
+}
+
+void EventAction::WriteChargeRow(const G4Event* event)
+{
+    ChargeReadout::Process(GetChargeSD()->GetClusters(),
+                           event->GetPrimaryVertex()->GetT0(), fChargeImage);
+
+    const auto info = static_cast<const EventInformation*>(event->GetUserInformation());
+    const G4int id  = RunAction::kChargeNtuple;
+
+    // Fill the charge table (table id = kChargeNtuple)
+    auto sink = OutputSink::Instance();
+    sink->FillIColumn(id, 0, info ? info->GetGlobalID() : event->GetEventID());
+    sink->FillIColumn(id, 1, static_cast<G4int>(fChargeImage.charge.size()));
+    sink->AddRow(id);
+}
+
+} // namespace ToyLArTPC
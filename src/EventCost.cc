@@ -0,0 +1,154 @@
+/// \file EventCost.cc
+/// \brief Implementation of the ToyLArTPC::EventCost class.
+
+#include "EventCost.hh"
+#include "EventInformation.hh"
+#include "RandomStreams.hh"
+#include "RunAction.hh"
+#include "WorkerInitialization.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+G4bool                     EventCost::fgEnabled   = false;
+G4bool                     EventCost::fgReplaying = false;
+std::vector<unsigned long> EventCost::fgReplayState;
+G4double                   EventCost::fgReplayT0 = 0.;
+
+G4ThreadLocal EventCost::ThreadState* EventCost::fgState = nullptr;
+
+EventCost::ThreadState& EventCost::State()
+{
+    if (!fgState) fgState = new ThreadState;
+    return *fgState;
+}
+
+void EventCost::BeginEvent(std::uint64_t globalEventID)
+{
+    auto& state = State();
+    state.global      = globalEventID;
+    state.engineState = G4Random::getTheEngine()->put();
+    state.start       = WorkerInitialization::Now();
+}
+
+void EventCost::EndEvent(const G4Event* event, std::size_t nHits)
+{
+    auto& state = State();
+    const G4double wall = WorkerInitialization::Now() - state.start;
+
+    if (!state.file) {
+        const G4int thread = G4Threading::G4GetThreadId();
+        std::string name = RunAction::GetOutputFileName() + "_cost";
+        if (thread >= 0) name += "_t" + std::to_string(thread);
+        name += ".txt";
+        state.file = std::fopen(name.c_str(), "w");
+        if (!state.file) {
+            throw std::runtime_error("EventCost: cannot open " + name);
+        }
+        std::fprintf(state.file, "# seed %llu\n",
+                     static_cast<unsigned long long>(RandomStreams::GetSeed()));
+        std::fprintf(state.file, "# global_id event_id wall_s marley_index"
+                                 " vx vy vz t0 n_hits engine_state...\n");
+    }
+
+    const auto info   = static_cast<const EventInformation*>(event->GetUserInformation());
+    const auto primary = event->GetPrimaryVertex();
+    const auto vertex  = primary->GetPosition();
+    std::fprintf(state.file, "%llu %d %.6f %d %.3f %.3f %.3f %.17g %zu",
+                 static_cast<unsigned long long>(state.global), event->GetEventID(),
+                 wall, info ? info->GetMarleyIndex() : -1,
+                 vertex.x(), vertex.y(), vertex.z(), primary->GetT0(), nHits);
+    for (const auto word : state.engineState) {
+        std::fprintf(state.file, " %lu", word);
+    }
+    std::fputc('\n', state.file);
+
+    if (wall > state.slowest) {
+        state.slowest   = wall;
+        state.slowestID = state.global;
+    }
+    ++state.events;
+}
+
+void EventCost::EndOfThreadRun()
+{
+    auto& state = State();
+    if (state.file) {
+        std::fclose(state.file);
+        state.file = nullptr;
+    }
+    if (state.events > 0) {
+        G4cout << "EventCost: slowest of " << state.events << " events is "
+               << state.slowestID << " (" << state.slowest << " s)" << G4endl;
+    }
+    state.slowest = -1.;
+    state.events  = 0;
+}
+
+bool EventCost::LoadReplay(const std::string& output, std::uint64_t globalEventID)
+{
+    namespace fs = std::filesystem;
+    const fs::path base(output);
+    const fs::path directory = base.has_parent_path() ? base.parent_path() : fs::path(".");
+    const std::regex pattern(base.filename().string()
+                             + "(_part[0-9]+)?_cost(_t[0-9]+)?\\.txt");
+
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        if (!std::regex_match(entry.path().filename().string(), pattern)) continue;
+
+        std::ifstream in(entry.path());
+        std::string line;
+        bool hasSeed = false;
+        unsigned long long seed = 0;
+        while (std::getline(in, line)) {
+            if (line.compare(0, 7, "# seed ") == 0) {
+                hasSeed = static_cast<bool>(std::istringstream(line.substr(7)) >> seed);
+                continue;
+            }
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            unsigned long long global = 0;
+            if (!(fields >> global) || global != globalEventID) continue;
+
+            std::string skip;
+            for (int i = 0; i < 6; ++i) fields >> skip;   // event_id .. vz
+            G4double t0 = 0.;
+            fields >> t0 >> skip;                         // t0, n_hits
+            fgReplayState.clear();
+            unsigned long word = 0;
+            while (fields >> word) fgReplayState.push_back(word);
+            if (fgReplayState.empty()) continue;
+
+            fgReplaying = true;
+            fgReplayT0  = t0;
+            // Files written before the seed was recorded need the original -seed
+            if (hasSeed) RandomStreams::SetSeed(seed);
+            G4cout << "EventCost: replaying event " << globalEventID
+                   << " from " << entry.path().string()
+                   << " (seed " << RandomStreams::GetSeed() << ")" << G4endl;
+            return true;
+        }
+    }
+    return false;
+}
+
+void EventCost::RestoreEngine()
+{
+    if (!G4Random::getTheEngine()->get(fgReplayState)) {
+        throw std::runtime_error(
+            "EventCost: recorded engine state does not fit the current engine");
+    }
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,84 @@
+/// \file EventIndex.cc
+/// \brief Implementation of the writing side of ToyLArTPC::EventIndex.
+
+#include "EventIndex.hh"
+
+#include "globals.hh"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace ToyLArTPC {
+
+namespace {
+
+/// `file` relative to the directory of the index at `indexPath`, where
+/// readers resolve it.  Both carry the same -output directory.
+std::string RelativeToIndex(const std::string& file, const std::string& indexPath)
+{
+    const auto directory = std::filesystem::path(indexPath).parent_path();
+    if (directory.empty()) return file;
+    const auto relative = std::filesystem::path(file).lexically_relative(directory);
+    return relative.empty() ? file : relative.string();
+}
+
+} // anonymous namespace
+
+std::mutex                   EventIndex::fgMutex;
+std::vector<std::string>     EventIndex::fgFiles;
+std::vector<EventIndexEntry> EventIndex::fgEntries;
+
+void EventIndex::AddThread(const std::string& file, const std::vector<EventIndexEntry>& entries)
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    const auto fileIndex = static_cast<std::int64_t>(fgFiles.size());
+    fgFiles.push_back(file);
+    for (auto entry : entries) {
+        entry.file = fileIndex;
+        fgEntries.push_back(entry);
+    }
+}
+
+std::uint64_t EventIndex::Write(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+
+    std::sort(fgEntries.begin(), fgEntries.end(),
+              [](const EventIndexEntry& a, const EventIndexEntry& b) { return a.event < b.event; });
+    std::uint32_t contiguous = 1;
+    for (std::size_t k = 1; k < fgEntries.size(); ++k) {
+        if (fgEntries[k].event != fgEntries[0].event + static_cast<std::int64_t>(k)) {
+            contiguous = 0;
+            break;
+        }
+    }
+
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        throw std::runtime_error("EventIndex: cannot create " + path);
+    }
+    const auto nFiles   = static_cast<std::uint32_t>(fgFiles.size());
+    const auto nEntries = static_cast<std::uint64_t>(fgEntries.size());
+    std::fwrite(kMagic, sizeof(kMagic), 1, out);
+    std::fwrite(&kVersion, sizeof(kVersion), 1, out);
+    std::fwrite(&nFiles, sizeof(nFiles), 1, out);
+    for (const auto& name : fgFiles) {
+        const auto file   = RelativeToIndex(name, path);
+        const auto length = static_cast<std::uint32_t>(file.size());
+        std::fwrite(&length, sizeof(length), 1, out);
+        std::fwrite(file.data(), 1, length, out);
+    }
+    std::fwrite(&nEntries, sizeof(nEntries), 1, out);
+    std::fwrite(&contiguous, sizeof(contiguous), 1, out);
+    std::fwrite(fgEntries.data(), sizeof(EventIndexEntry), fgEntries.size(), out);
+    std::fclose(out);
+
+    G4cout << "EventIndex: " << nEntries << " events in " << nFiles
+           << " files indexed in " << path << G4endl;
+
+    fgFiles.clear();
+    fgEntries.clear();
+    return nEntries;
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,129 @@
+/// \file MemoryMonitor.cc
+/// \brief Implementation of the ToyLArTPC::MemoryMonitor class.
+
+#include "MemoryMonitor.hh"
+#include "PhotonHit.hh"
+#include "PrimaryGeneratorAction.hh"
+
+#include "G4Threading.hh"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace ToyLArTPC {
+
+namespace {
+
+inline G4double MB(std::size_t bytes) { return bytes / (1024. * 1024.); }
+
+} // anonymous namespace
+
+G4bool MemoryMonitor::fgEnabled  = false;
+G4bool MemoryMonitor::fgPerEvent = false;
+
+G4ThreadLocal MemoryMonitor::Usage* MemoryMonitor::fgThreadUsage = nullptr;
+
+std::mutex           MemoryMonitor::fgMutex;
+MemoryMonitor::Usage MemoryMonitor::fgRun;
+std::size_t          MemoryMonitor::fgTotalHitPools = 0;
+G4int                MemoryMonitor::fgThreads       = 0;
+
+void MemoryMonitor::Enable(G4bool perEvent)
+{
+    fgEnabled  = true;
+    fgPerEvent = perEvent;
+}
+
+std::size_t MemoryMonitor::GetResidentBytes()
+{
+    // Second field of /proc/self/statm: resident pages
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) return 0;
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+MemoryMonitor::Usage& MemoryMonitor::ThreadUsage()
+{
+    if (!fgThreadUsage) fgThreadUsage = new Usage;
+    return *fgThreadUsage;
+}
+
+void MemoryMonitor::RecordStackDepth(G4int depth)
+{
+    auto& usage = ThreadUsage();
+    usage.eventStackDepth = std::max(usage.eventStackDepth, depth);
+}
+
+void MemoryMonitor::RecordEvent(G4int eventID, std::size_t nHits)
+{
+    auto& usage = ThreadUsage();
+    const std::size_t pool =
+        PhotonHitAllocator ? PhotonHitAllocator->GetAllocatedSize() : 0;
+    const std::size_t resident = GetResidentBytes();
+
+    usage.hitPoolBytes   = std::max(usage.hitPoolBytes, pool);
+    usage.peakHits       = std::max(usage.peakHits, nHits);
+    usage.peakStackDepth = std::max(usage.peakStackDepth, usage.eventStackDepth);
+    usage.peakResident   = std::max(usage.peakResident, resident);
+    ++usage.events;
+
+    if (fgPerEvent) {
+        G4cout << std::fixed << std::setprecision(1)
+               << "Memory: event " << eventID
+               << " hits " << nHits
+               << " stack " << usage.eventStackDepth
+               << " hit_pool_MB " << MB(pool)
+               << " rss_MB " << MB(resident)
+               << std::defaultfloat << G4endl;
+    }
+    usage.eventStackDepth = 0;
+}
+
+void MemoryMonitor::EndOfThreadRun()
+{
+    auto& usage = ThreadUsage();
+
+    std::lock_guard<std::mutex> lock(fgMutex);
+    fgRun.hitPoolBytes   = std::max(fgRun.hitPoolBytes, usage.hitPoolBytes);
+    fgRun.peakHits       = std::max(fgRun.peakHits, usage.peakHits);
+    fgRun.peakStackDepth = std::max(fgRun.peakStackDepth, usage.peakStackDepth);
+    fgRun.peakResident   = std::max(fgRun.peakResident, usage.peakResident);
+    fgRun.events        += usage.events;
+    fgTotalHitPools     += usage.hitPoolBytes;
+    ++fgThreads;
+
+    // The pool keeps its pages, so its size carries over between runs
+    const std::size_t pool = usage.hitPoolBytes;
+    usage = Usage();
+    usage.hitPoolBytes = pool;
+}
+
+void MemoryMonitor::Report()
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    const std::size_t resident = GetResidentBytes();
+
+    G4cout << std::fixed << std::setprecision(1)
+           << "Memory usage (" << fgRun.events << " events, "
+           << fgThreads << " threads):\n"
+           << "  MARLEY event cache        "
+           << MB(PrimaryGeneratorAction::GetEventCacheBytes()) << " MB\n"
+           << "  PhotonHit pool per thread " << MB(fgRun.hitPoolBytes)
+           << " MB max, " << MB(fgTotalHitPools) << " MB all threads\n"
+           << "  peak hits per event       " << fgRun.peakHits << " ("
+           << MB(fgRun.peakHits * sizeof(PhotonHit)) << " MB)\n"
+           << "  peak photon stack depth   " << fgRun.peakStackDepth << " tracks\n"
+           << "  process RSS               " << MB(fgRun.peakResident)
+           << " MB peak, " << MB(resident) << " MB now"
+           << std::defaultfloat << G4endl;
+
+    fgRun = Usage();
+    fgTotalHitPools = 0;
+    fgThreads       = 0;
+}
+
+} // namespace ToyLArTPC
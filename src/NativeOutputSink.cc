@@ -0,0 +1,348 @@
+/// \file NativeOutputSink.cc
+/// \brief Implementation of the ToyLArTPC::NativeOutputSink class.
+
+#include "NativeOutputSink.hh"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace {
+
+void Append(std::vector<char>& out, const void* data, std::size_t size)
+{
+    const auto bytes = static_cast<const char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+void AppendString(std::vector<char>& out, const G4String& s)
+{
+    const auto length = static_cast<std::uint32_t>(s.size());
+    Append(out, &length, sizeof(length));
+    Append(out, s.data(), length);
+}
+
+} // anonymous namespace
+
+NativeOutputSink::NativeOutputSink(G4int compression)
+    : fCompression(compression)
+{
+#ifndef TOYLARTPC_WITH_ZSTD
+    if (fCompression > 0) {
+        throw std::runtime_error("NativeOutputSink: built without zstd, cannot compress");
+    }
+#endif
+}
+
+NativeOutputSink::~NativeOutputSink()
+{
+    if (fFile) DoClose();
+}
+
+G4int NativeOutputSink::CreateTable(const G4String& name, const G4String& title)
+{
+    fTables.emplace_back();
+    fTables.back().name  = name;
+    fTables.back().title = title;
+    return static_cast<G4int>(fTables.size()) - 1;
+}
+
+NativeOutputSink::Column& NativeOutputSink::AddColumn(const G4String& name, std::uint8_t type)
+{
+    auto& columns = fTables.back().columns;
+    columns.emplace_back();
+    columns.back().name = name;
+    columns.back().type = type;
+    return columns.back();
+}
+
+void NativeOutputSink::CreateIColumn(const G4String& name)
+{
+    AddColumn(name, Columnar::kInt32);
+}
+
+void NativeOutputSink::CreateFColumn(const G4String& name)
+{
+    AddColumn(name, Columnar::kFloat32);
+}
+
+void NativeOutputSink::CreateDColumn(const G4String& name)
+{
+    AddColumn(name, Columnar::kFloat64);
+}
+
+void NativeOutputSink::CreateIColumn(const G4String& name, std::vector<G4int>& values)
+{
+    auto& column  = AddColumn(name, Columnar::kInt32);
+    column.vector = true;
+    column.ints   = &values;
+}
+
+void NativeOutputSink::CreateFColumn(const G4String& name, std::vector<G4float>& values)
+{
+    auto& column  = AddColumn(name, Columnar::kFloat32);
+    column.vector = true;
+    column.floats = &values;
+}
+
+template <typename T>
+void NativeOutputSink::Store(G4int table, G4int column, T value)
+{
+    // Converted to the declared type of the column
+    auto& col = fTables[table].columns[column];
+    switch (col.type) {
+        case Columnar::kInt32: {
+            const auto v = static_cast<std::int32_t>(value);
+            std::memcpy(col.value, &v, sizeof(v));
+            break;
+        }
+        case Columnar::kFloat32: {
+            const auto v = static_cast<float>(value);
+            std::memcpy(col.value, &v, sizeof(v));
+            break;
+        }
+        default: {
+            const auto v = static_cast<double>(value);
+            std::memcpy(col.value, &v, sizeof(v));
+        }
+    }
+}
+
+void NativeOutputSink::FillIColumn(G4int table, G4int column, G4int value)
+{
+    Store(table, column, value);
+}
+
+void NativeOutputSink::FillFColumn(G4int table, G4int column, G4float value)
+{
+    Store(table, column, value);
+}
+
+void NativeOutputSink::FillDColumn(G4int table, G4int column, G4double value)
+{
+    Store(table, column, value);
+}
+
+void NativeOutputSink::DoAddRow(G4int id)
+{
+    auto& table = fTables[id];
+    for (auto& column : table.columns) {
+        const std::size_t before = column.data.size();
+        if (!column.vector) {
+            Append(column.data, column.value, Columnar::TypeSize(column.type));
+        } else if (column.ints) {
+            Append(column.data, column.ints->data(), column.ints->size() * sizeof(G4int));
+            column.ends.push_back(column.data.size() / sizeof(G4int));
+        } else {
+            Append(column.data, column.floats->data(), column.floats->size() * sizeof(G4float));
+            column.ends.push_back(column.data.size() / sizeof(G4float));
+        }
+        table.bytes += column.data.size() - before;
+    }
+    ++table.rows;
+    fDirty = true;
+
+    if (table.rows >= kChunkRows || table.bytes >= kChunkBytes) {
+        WriteChunk(table);
+    }
+}
+
+G4String NativeOutputSink::DoOpen(const G4String& baseName)
+{
+    const G4String name = ThreadFileName(baseName, ".tlc");
+    fFile = std::fopen(name.c_str(), "wb");
+    if (!fFile) {
+        throw std::runtime_error("NativeOutputSink: cannot create " + name);
+    }
+
+    // Header without a footer until the first flush
+    char header[Columnar::kHeaderSize] = {};
+    std::memcpy(header, Columnar::kMagic, sizeof(Columnar::kMagic));
+    std::memcpy(header + 8, &Columnar::kVersion, sizeof(Columnar::kVersion));
+    std::fwrite(header, sizeof(header), 1, fFile);
+    fEnd = sizeof(header);
+
+    for (auto& table : fTables) {
+        table.chunks.clear();
+        table.listedChunks = 0;
+        ResetOpenChunk(table);
+    }
+    fDirty          = false;
+    fHasFooter      = false;
+    fFooterComplete = false;
+    fFooterOffset   = 0;
+    fFooterSize     = 0;
+    return name;
+}
+
+void NativeOutputSink::DoFlush()
+{
+    if (!fFile || (!fDirty && fHasFooter)) return;
+    for (auto& table : fTables) {
+        if (table.rows > table.flushedRows) WriteTail(table);
+    }
+    WriteFooter(false);
+}
+
+void NativeOutputSink::DoClose()
+{
+    // The open chunks are written whole, so flushes leave no small chunks
+    for (auto& table : fTables) {
+        if (table.rows > 0) WriteChunk(table);
+    }
+    if (fDirty || !fFooterComplete) WriteFooter(true);
+    std::fclose(fFile);
+    fFile = nullptr;
+}
+
+void NativeOutputSink::WriteChunk(Table& table)
+{
+    Chunk chunk;
+    chunk.rows = table.rows;
+    for (auto& column : table.columns) {
+        if (column.vector) {
+            chunk.blocks.push_back(WriteBlock(column.ends.data(),
+                                              column.ends.size() * sizeof(std::uint64_t)));
+        }
+        chunk.blocks.push_back(WriteBlock(column.data.data(), column.data.size()));
+    }
+    table.chunks.push_back(std::move(chunk));
+    ResetOpenChunk(table);
+}
+
+void NativeOutputSink::WriteTail(Table& table)
+{
+    Chunk piece;
+    piece.rows = table.rows - table.flushedRows;
+    for (auto& column : table.columns) {
+        if (column.vector) {
+            // Row ends count from the start of the piece
+            const std::uint64_t base = column.flushedData / Columnar::TypeSize(column.type);
+            fEnds.assign(column.ends.begin() + column.flushedEnds, column.ends.end());
+            for (auto& end : fEnds) end -= base;
+            piece.blocks.push_back(WriteBlock(fEnds.data(), fEnds.size() * sizeof(std::uint64_t)));
+            column.flushedEnds = column.ends.size();
+        }
+        piece.blocks.push_back(WriteBlock(column.data.data() + column.flushedData,
+                                          column.data.size() - column.flushedData));
+        column.flushedData = column.data.size();
+    }
+    table.tail.push_back(std::move(piece));
+    table.flushedRows = table.rows;
+}
+
+void NativeOutputSink::ResetOpenChunk(Table& table)
+{
+    table.rows        = 0;
+    table.bytes       = 0;
+    table.flushedRows = 0;
+    table.tail.clear();
+    table.listedTail  = 0;
+    for (auto& column : table.columns) {
+        column.data.clear();
+        column.ends.clear();
+        column.flushedData = 0;
+        column.flushedEnds = 0;
+    }
+}
+
+Columnar::Block NativeOutputSink::WriteBlock(const void* data, std::size_t size)
+{
+    Columnar::Block block;
+    block.rawSize    = size;
+    block.storedSize = size;
+
+#ifdef TOYLARTPC_WITH_ZSTD
+    if (fCompression > 0 && size > 0) {
+        fBuffer.resize(ZSTD_compressBound(size));
+        const std::size_t n = ZSTD_compress(fBuffer.data(), fBuffer.size(),
+                                            data, size, fCompression);
+        if (!ZSTD_isError(n) && n < size) {
+            data             = fBuffer.data();
+            block.storedSize = n;
+            block.codec      = Columnar::kZstd;
+        }
+    }
+#endif
+
+    // Align every block to 8 bytes so raw blocks can be used in place
+    static const char kZeros[8] = {};
+    const std::uint64_t padding = (8 - fEnd % 8) % 8;
+    std::fwrite(kZeros, 1, padding, fFile);
+    block.offset = fEnd + padding;
+    if (block.storedSize > 0 && std::fwrite(data, block.storedSize, 1, fFile) != 1) {
+        throw std::runtime_error("NativeOutputSink: write failed");
+    }
+    fEnd = block.offset + block.storedSize;
+    return block;
+}
+
+void NativeOutputSink::WriteFooter(G4bool consolidate)
+{
+    // A flush lists only the chunks written since the last footer, which
+    // it points back to; the consolidated footer lists them all
+    const G4bool chained = !consolidate && fHasFooter;
+    const std::uint64_t previous[2] = { chained ? fFooterOffset : 0,
+                                        chained ? fFooterSize   : 0 };
+    G4bool hasTail = false;
+
+    auto& footer = fBuffer;
+    footer.clear();
+    Append(footer, previous, sizeof(previous));
+    const auto nTables = static_cast<std::uint32_t>(fTables.size());
+    Append(footer, &nTables, sizeof(nTables));
+    for (const auto& table : fTables) {
+        AppendString(footer, table.name);
+        AppendString(footer, table.title);
+        const auto nColumns = static_cast<std::uint32_t>(table.columns.size());
+        Append(footer, &nColumns, sizeof(nColumns));
+        for (const auto& column : table.columns) {
+            const std::uint8_t vector = column.vector ? 1 : 0;
+            AppendString(footer, column.name);
+            Append(footer, &column.type, 1);
+            Append(footer, &vector, 1);
+        }
+        auto appendChunks = [&footer](auto first, auto last) {
+            const auto n = static_cast<std::uint32_t>(last - first);
+            Append(footer, &n, sizeof(n));
+            for (auto chunk = first; chunk != last; ++chunk) {
+                Append(footer, &chunk->rows, sizeof(chunk->rows));
+                Append(footer, chunk->blocks.data(),
+                       chunk->blocks.size() * sizeof(Columnar::Block));
+            }
+        };
+        // Pieces listed before stay valid until their chunk is written whole
+        const std::size_t listed = chained ? table.listedChunks : 0;
+        const auto        kept   = static_cast<std::uint32_t>(chained ? table.listedTail : 0);
+        appendChunks(table.chunks.begin() + listed, table.chunks.end());
+        Append(footer, &kept, sizeof(kept));
+        appendChunks(table.tail.begin() + kept, table.tail.end());   // Empty at Close
+        hasTail = hasTail || !table.tail.empty();
+    }
+
+    // The footer is appended, never written over data; the header points at
+    // it only once it is complete
+    const std::uint64_t offset = fEnd;
+    const std::uint64_t size   = footer.size();
+    std::fwrite(footer.data(), 1, footer.size(), fFile);
+    std::fflush(fFile);
+    std::fseek(fFile, 16, SEEK_SET);
+    std::fwrite(&offset, sizeof(offset), 1, fFile);
+    std::fwrite(&size, sizeof(size), 1, fFile);
+    std::fflush(fFile);
+    std::fseek(fFile, 0, SEEK_END);
+    fEnd = offset + size;
+
+    for (auto& table : fTables) {
+        table.listedChunks = table.chunks.size();
+        table.listedTail   = table.tail.size();
+    }
+    fFooterOffset   = offset;
+    fFooterSize     = size;
+    fFooterComplete = !chained && !hasTail;
+    fDirty          = false;
+    fHasFooter      = true;
+}
+
+} // namespace ToyLArTPC
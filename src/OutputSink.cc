@@ -0,0 +1,114 @@
+/// \file OutputSink.cc
+/// \brief Implementation of the ToyLArTPC::OutputSink class.
+
+#include "OutputSink.hh"
+#include "NativeOutputSink.hh"
+#include "RootOutputSink.hh"
+#include "WorkerInitialization.hh"
+
+#include "G4Threading.hh"
+
+#include <filesystem>
+#include <iomanip>
+
+namespace ToyLArTPC {
+
+OutputSink::Backend OutputSink::fgBackend     = OutputSink::Backend::Root;
+G4int               OutputSink::fgCompression = 0;
+
+G4ThreadLocal OutputSink* OutputSink::fgInstance = nullptr;
+
+std::mutex         OutputSink::fgMutex;
+OutputSink::Totals OutputSink::fgJob;
+
+void OutputSink::SetBackend(Backend backend, G4int compression)
+{
+    fgBackend     = backend;
+    fgCompression = compression;
+}
+
+OutputSink* OutputSink::Instance()
+{
+    if (!fgInstance) {
+        if (fgBackend == Backend::Native) {
+            fgInstance = new NativeOutputSink(fgCompression);
+        } else {
+            fgInstance = new RootOutputSink();
+        }
+    }
+    return fgInstance;
+}
+
+G4String OutputSink::ThreadFileName(const G4String& baseName, const G4String& extension)
+{
+    const G4int thread = G4Threading::G4GetThreadId();
+    return (thread >= 0)
+        ? baseName + "_t" + std::to_string(thread) + extension
+        : baseName + extension;
+}
+
+void OutputSink::AddRow(G4int table)
+{
+    const G4double start = WorkerInitialization::Now();
+    DoAddRow(table);
+    fThread.seconds += WorkerInitialization::Now() - start;
+    ++fThread.rows;
+}
+
+void OutputSink::Open(const G4String& baseName)
+{
+    const G4double start = WorkerInitialization::Now();
+    fFileName = DoOpen(baseName);
+    fThread.seconds += WorkerInitialization::Now() - start;
+}
+
+void OutputSink::Flush()
+{
+    const G4double start = WorkerInitialization::Now();
+    DoFlush();
+    fThread.seconds += WorkerInitialization::Now() - start;
+}
+
+void OutputSink::Close()
+{
+    const G4double start = WorkerInitialization::Now();
+    DoClose();
+    fThread.seconds += WorkerInitialization::Now() - start;
+
+    std::error_code error;
+    const auto size = std::filesystem::file_size(fFileName.c_str(), error);
+    if (!error) fThread.bytes += size;
+    ++fThread.files;
+}
+
+void OutputSink::EndOfThreadRun()
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    fgJob.rows    += fThread.rows;
+    fgJob.bytes   += fThread.bytes;
+    fgJob.seconds += fThread.seconds;
+    fgJob.files   += fThread.files;
+    fThread = Totals();
+}
+
+void OutputSink::Report()
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    if (fgJob.files == 0) return;
+
+    G4cout << std::fixed << std::setprecision(2)
+           << "Output (" << (fgBackend == Backend::Native ? "native" : "root");
+    if (fgBackend == Backend::Native && fgCompression > 0) {
+        G4cout << ", zstd " << fgCompression;
+    }
+    G4cout << "): " << fgJob.rows << " rows, "
+           << fgJob.bytes / (1024. * 1024.) << " MB in " << fgJob.files << " files, "
+           << fgJob.seconds << " thread-s in the sink ("
+           << std::setprecision(0)
+           << (fgJob.seconds > 0. ? fgJob.rows / fgJob.seconds : 0.) << " rows/s per thread)"
+           << std::defaultfloat << G4endl;
+
+    fgJob = Totals();
+}
+
+} // namespace ToyLArTPC
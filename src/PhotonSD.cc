@@ -2,6 +2,8 @@
 /// \brief Implementation of the ToyLArTPC::PhotonSD class.
 
 #include "PhotonSD.hh"
+#include "DetectorParameters.hh"
+#include "RandomStreams.hh"
 
 #include "G4Step.hh"
 #include "G4Track.hh"
@@ -9,14 +11,20 @@
 #include "G4HCofThisEvent.hh"
 #include "G4SDManager.hh"
 #include "G4SystemOfUnits.hh"
-#include "Randomize.hh"
+
+#include <algorithm>
+#include <vector>
 
 namespace ToyLArTPC {
 
+G4double PhotonSD::fgEfficiency       = 1.0;
+G4bool   PhotonSD::fgBuildTileSummary = false;
+
 PhotonSD::PhotonSD(const G4String& name, const G4String& hitsCollectionName)
     : G4VSensitiveDetector(name)
 {
     collectionName.insert(hitsCollectionName);
+    collectionName.insert("TileCountsCollection");
 }
 
 void PhotonSD::Initialize(G4HCofThisEvent* hce)
@@ -28,6 +36,15 @@ void PhotonSD::Initialize(G4HCofThisEvent* hce)
     G4int hcID = G4SDManager::GetSDMpointer()
                      ->GetCollectionID(collectionName[0]);
     hce->AddHitsCollection(hcID, fHitsCollection);
+
+    // Per-tile summary for the visualization heatmap (filled in EndOfEvent)
+    fTileCollection = nullptr;
+    if (fgBuildTileSummary) {
+        fTileCollection = new TileHitsCollection(SensitiveDetectorName, collectionName[1]);
+        G4int tileHCID = G4SDManager::GetSDMpointer()
+                             ->GetCollectionID(collectionName[1]);
+        hce->AddHitsCollection(tileHCID, fTileCollection);
+    }
 }
 
 G4bool PhotonSD::ProcessHits(G4Step* step, G4TouchableHistory* /*history*/)
@@ -38,8 +55,8 @@ G4bool PhotonSD::ProcessHits(G4Step* step, G4TouchableHistory* /*history*/)
         return false;
 
     // ---- Apply detection efficiency ----
-    if (fEfficiency < 1.0) {
-        if (G4UniformRand() > fEfficiency)
+    if (fgEfficiency < 1.0) {
+        if (RandomStreams::Get(RandomStreams::kDetection).Flat() > fgEfficiency)
             return false;
     }
 
@@ -49,6 +66,7 @@ G4bool PhotonSD::ProcessHits(G4Step* step, G4TouchableHistory* /*history*/)
     // Tile copy number (identifies which tile was hit)
     G4int tileID = step->GetPreStepPoint()->GetTouchableHandle()->GetCopyNumber();
     hit->SetTileID(tileID);
+    hit->SetTrackID(track->GetTrackID());
 
     hit->SetTime(step->GetPreStepPoint()->GetGlobalTime());
     hit->SetPosition(step->GetPreStepPoint()->GetPosition());
@@ -68,5 +86,28 @@ G4bool PhotonSD::ProcessHits(G4Step* step, G4TouchableHistory* /*history*/)
     return true;
 }
 
-} // namespace ToyLArTPC
+void PhotonSD::EndOfEvent(G4HCofThisEvent* /*hce*/)
+{
+    if (!fTileCollection) return;
+
+    const G4int nTiles = DetectorParameters::kNTiles;
+    std::vector<G4int> counts(nTiles, 0);
 
+    const auto nHits = fHitsCollection->entries();
+    for (std::size_t i = 0; i < nHits; ++i) {
+        G4int tileID = (*fHitsCollection)[i]->GetTileID();
+        if (tileID >= 0 && tileID < nTiles) {
+            counts[tileID]++;
+        }
+    }
+
+    const G4int maxCount = *std::max_element(counts.begin(), counts.end());
+    for (G4int tileID = 0; tileID < nTiles; ++tileID) {
+        if (counts[tileID] == 0) continue;
+        fTileCollection->insert(new TileHit(
+            tileID, counts[tileID],
+            static_cast<G4double>(counts[tileID]) / maxCount));
+    }
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,79 @@
+/// \file PhysicsTableCache.cc
+/// \brief Implementation of the ToyLArTPC::PhysicsTableCache class.
+
+#include "PhysicsTableCache.hh"
+
+#include "G4VUserPhysicsList.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace ToyLArTPC {
+
+namespace {
+
+/// Name of the marker file written after a successful store.
+const char* const kStampFile = "configuration.txt";
+
+/// 64-bit FNV-1a hash (stable across compilers and runs, unlike std::hash).
+std::uint64_t Fnv1a(const std::string& text)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // anonymous namespace
+
+PhysicsTableCache::PhysicsTableCache(const std::string& baseDir,
+                                     const std::string& configuration)
+    : fConfiguration(configuration)
+{
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(Fnv1a(configuration)));
+    fDirectory = (std::filesystem::path(baseDir) / hex).string();
+}
+
+bool PhysicsTableCache::IsPopulated() const
+{
+    return std::filesystem::exists(
+        std::filesystem::path(fDirectory) / kStampFile);
+}
+
+void PhysicsTableCache::Retrieve(G4VUserPhysicsList* physicsList) const
+{
+    if (!IsPopulated()) return;
+    physicsList->SetPhysicsTableRetrieved(fDirectory);
+    G4cout << "PhysicsTableCache: retrieving physics tables from "
+           << fDirectory << G4endl;
+}
+
+bool PhysicsTableCache::Store(G4VUserPhysicsList* physicsList) const
+{
+    if (IsPopulated()) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(fDirectory, ec);
+    if (ec || !physicsList->StorePhysicsTable(fDirectory)) {
+        G4cerr << "PhysicsTableCache: cannot store physics tables in "
+               << fDirectory << G4endl;
+        return false;
+    }
+
+    // Written last, so an interrupted store is never mistaken for a
+    // complete one.
+    std::ofstream stamp(std::filesystem::path(fDirectory) / kStampFile);
+    stamp << fConfiguration << '\n';
+
+    G4cout << "PhysicsTableCache: stored physics tables in "
+           << fDirectory << G4endl;
+    return true;
+}
+
+} // namespace ToyLArTPC
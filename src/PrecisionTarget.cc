@@ -0,0 +1,161 @@
+/// \file PrecisionTarget.cc
+/// \brief Implementation of the ToyLArTPC::PrecisionTarget class.
+
+#include "PrecisionTarget.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace {
+
+/// Progress towards one target over a set of quantities.
+struct Status {
+    G4double worst    = 0.;   ///< Largest relative error
+    G4int    worstAt  = -1;
+    G4double factor   = 1.;   ///< Events needed over events so far
+    G4int    met      = 0;
+    G4int    checked  = 0;
+};
+
+} // anonymous namespace
+
+G4bool            PrecisionTarget::fgEnabled = false;
+PrecisionSettings PrecisionTarget::fgSettings;
+
+G4ThreadLocal PrecisionTarget::Accumulator* PrecisionTarget::fgThreadAccumulator = nullptr;
+
+std::mutex                                 PrecisionTarget::fgMutex;
+std::vector<PrecisionTarget::Accumulator*> PrecisionTarget::fgRegistry;
+
+void PrecisionTarget::Moments::Merge(const Moments& other)
+{
+    if (other.weight <= 0.) return;
+    const G4double total = weight + other.weight;
+    const G4double delta = other.mean - mean;
+    mean    += delta * other.weight / total;
+    m2      += other.m2 + delta * delta * weight * other.weight / total;
+    weight   = total;
+    weight2 += other.weight2;
+}
+
+G4double PrecisionTarget::Moments::RelativeError() const
+{
+    // Weighted variance m2 / W with Bessel's correction for the effective
+    // count n, over n: reduces to m2 / (N (N - 1)) for unit weights
+    const G4double n = Effective();
+    if (n <= 1. || mean == 0.) return std::numeric_limits<G4double>::infinity();
+    return std::sqrt(m2 / weight / (n - 1.)) / std::abs(mean);
+}
+
+void PrecisionTarget::Configure(const PrecisionSettings& settings)
+{
+    if (settings.tileMean < 0. || settings.vertexMean < 0.
+        || (settings.tileMean == 0. && settings.vertexMean == 0.)) {
+        throw std::runtime_error("PrecisionTarget: need a positive tile or vertex-bin target");
+    }
+    if (settings.batch < 1) {
+        throw std::runtime_error("PrecisionTarget: batches need at least one event");
+    }
+    fgSettings = settings;
+    fgEnabled  = true;
+}
+
+PrecisionTarget::Accumulator& PrecisionTarget::ThreadAccumulator()
+{
+    if (!fgThreadAccumulator) {
+        fgThreadAccumulator = new Accumulator;   // aligned new (C++17)
+        std::lock_guard<std::mutex> lock(fgMutex);
+        fgRegistry.push_back(fgThreadAccumulator);
+    }
+    return *fgThreadAccumulator;
+}
+
+void PrecisionTarget::Fill(const std::vector<G4int>& counts, G4int weight,
+                           G4double x, G4double y, G4double z)
+{
+    auto& acc = ThreadAccumulator();
+    const G4double w = weight;
+
+    G4int total = 0;
+    for (G4int i = 0; i < kNTiles; ++i) {
+        acc.tile[i].Add(counts[i], w);
+        total += counts[i];
+    }
+    acc.vertex[RunAggregates::VertexBin(x, y, z)].Add(total, w);
+}
+
+G4bool PrecisionTarget::Update(G4long processed, G4long& next)
+{
+    // Workers are idle between batches: their accumulators are stable
+    auto run = std::make_unique<Accumulator>();
+    {
+        std::lock_guard<std::mutex> lock(fgMutex);
+        for (const auto* acc : fgRegistry) {
+            for (G4int i = 0; i < kNTiles; ++i)     run->tile[i].Merge(acc->tile[i]);
+            for (G4int v = 0; v < kVertexBins; ++v) run->vertex[v].Merge(acc->vertex[v]);
+        }
+    }
+
+    auto check = [](const Moments* q, G4int n, G4double target) {
+        Status status;
+        if (target <= 0.) return status;
+        for (G4int k = 0; k < n; ++k) {
+            if (q[k].weight <= 0. || q[k].mean <= 0. || q[k].mean < fgSettings.minMean) continue;
+            ++status.checked;
+            const G4double error     = q[k].RelativeError();
+            const G4double effective = q[k].Effective();
+            G4double factor = kMinEvents / effective;
+            if (effective >= kMinEvents && std::isfinite(error)) {
+                factor = std::max(factor, (error / target) * (error / target));
+                if (error <= target) ++status.met;
+            }
+            if (status.worstAt < 0 || error > status.worst) {
+                status.worst   = error;
+                status.worstAt = k;
+            }
+            status.factor = std::max(status.factor, factor);
+        }
+        return status;
+    };
+    const Status tiles  = check(run->tile, kNTiles, fgSettings.tileMean);
+    const Status vertex = check(run->vertex, kVertexBins, fgSettings.vertexMean);
+
+    G4cout << std::setprecision(3) << "PrecisionTarget: " << processed << " events;";
+    if (fgSettings.tileMean > 0.) {
+        G4cout << " tiles " << tiles.met << "/" << tiles.checked << " met";
+        if (tiles.worstAt >= 0) {
+            G4cout << " (worst " << tiles.worst << " at tile " << tiles.worstAt << ")";
+        }
+        G4cout << ";";
+    }
+    if (fgSettings.vertexMean > 0.) {
+        G4cout << " vertex bins " << vertex.met << "/" << vertex.checked << " met";
+        if (vertex.worstAt >= 0) {
+            G4cout << " (worst " << vertex.worst << " at bin " << vertex.worstAt << ")";
+        }
+        G4cout << ";";
+    }
+
+    const G4bool done = tiles.met == tiles.checked && vertex.met == vertex.checked
+                     && tiles.checked + vertex.checked > 0;
+    if (done) {
+        G4cout << " all targets met" << std::defaultfloat << G4endl;
+        return true;
+    }
+
+    // Aim a little past the projection, but never more than double the run
+    const G4double factor   = std::max(tiles.factor, vertex.factor);
+    const auto     needed   = static_cast<G4long>(std::ceil(1.05 * factor * processed));
+    const G4long   minBatch = std::max<G4long>(1, fgSettings.batch / 10);
+    next = std::clamp(needed - processed, minBatch, std::max(processed, minBatch));
+    G4cout << " next batch " << next << std::defaultfloat << G4endl;
+    return false;
+}
+
+} // namespace ToyLArTPC
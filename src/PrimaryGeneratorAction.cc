@@ -3,26 +3,83 @@
 ///
 /// Reads pre-generated MARLEY events from a ROOT file and injects
 /// them into Geant4 as primary vertices.  Fully thread-safe.
+/// In Ar-39 mode, generates single beta-decay electrons instead.
 
 #include "PrimaryGeneratorAction.hh"
+#include "BurstReadout.hh"
+#include "EventCost.hh"
+#include "EventInformation.hh"
+#include "RandomStreams.hh"
+#include "VertexSampler.hh"
 
 #include "G4Event.hh"
+#include "G4PhysicalConstants.hh"
 #include "G4PrimaryParticle.hh"
 #include "G4PrimaryVertex.hh"
 #include "G4SystemOfUnits.hh"
-#include "Randomize.hh"
+#include "G4ThreeVector.hh"
 
 #include "TFile.h"
 #include "TTree.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
 namespace ToyLArTPC {
 
+namespace {
+
+/// Ar-39 -> K-39 beta decay (7/2- -> 3/2+, first-forbidden unique).
+constexpr G4double kAr39Q        = 0.565 * MeV;
+constexpr G4int    kAr39Daughter = 19;
+
+/// Unnormalised beta spectrum at kinetic energy `T`: phase space times the
+/// non-relativistic Fermi function and the unique first-forbidden shape
+/// factor p^2 + q^2 (q the neutrino momentum).
+G4double Ar39Spectrum(G4double T)
+{
+    if (T <= 0. || T >= kAr39Q) return 0.;
+    const G4double E   = T + electron_mass_c2;
+    const G4double p   = std::sqrt(T * (T + 2. * electron_mass_c2));
+    const G4double q   = kAr39Q - T;
+    const G4double x   = twopi * fine_structure_const * kAr39Daughter * E / p;
+    const G4double fermi = x / (1. - std::exp(-x));
+    return fermi * p * E * q * q * (p * p + q * q);
+}
+
+/// Sample a kinetic energy from the Ar-39 spectrum by rejection.
+G4double SampleAr39Energy(RandomStream& random)
+{
+    static const G4double maximum = [] {
+        G4double value = 0.;
+        for (G4int i = 1; i < 1000; ++i) {
+            value = std::max(value, Ar39Spectrum(kAr39Q * i / 1000.));
+        }
+        return 1.05 * value;
+    }();
+
+    for (;;) {
+        const G4double T = kAr39Q * random.Flat();
+        if (random.Flat() * maximum < Ar39Spectrum(T)) return T;
+    }
+}
+
+} // anonymous namespace
+
 // --- Static members ---
 std::vector<MarleyEventData> PrimaryGeneratorAction::fgEvents;
 std::atomic<int>             PrimaryGeneratorAction::fgNextEvent{0};
+int                          PrimaryGeneratorAction::fgRunBase   = 0;
+int                          PrimaryGeneratorAction::fgBaseRunID = -1;
+std::mutex                   PrimaryGeneratorAction::fgRunMutex;
+std::vector<std::unique_ptr<const std::vector<MarleyEventData>>>
+                             PrimaryGeneratorAction::fgReplicas;
+std::mutex                   PrimaryGeneratorAction::fgReplicaMutex;
+G4ThreadLocal const std::vector<MarleyEventData>*
+                             PrimaryGeneratorAction::fgLocalEvents = nullptr;
+G4bool                       PrimaryGeneratorAction::fgAr39Mode = false;
 
 void PrimaryGeneratorAction::LoadEvents(const std::string& eventFile)
 {
@@ -79,31 +136,116 @@ void PrimaryGeneratorAction::LoadEvents(const std::string& eventFile)
               << std::endl;
 }
 
+std::size_t PrimaryGeneratorAction::GetEventCacheBytes()
+{
+    std::size_t bytes = fgEvents.capacity() * sizeof(MarleyEventData);
+    for (const auto& ev : fgEvents) {
+        bytes += ev.pdg.capacity() * sizeof(int)
+               + (ev.px.capacity() + ev.py.capacity() + ev.pz.capacity()
+                  + ev.energy.capacity() + ev.mass.capacity()) * sizeof(double);
+    }
+    return bytes;
+}
+
+void PrimaryGeneratorAction::UseNodeReplica(G4int node)
+{
+    if (node < 0 || fgEvents.empty()) return;
+
+    std::lock_guard<std::mutex> lock(fgReplicaMutex);
+    if (fgReplicas.size() <= static_cast<std::size_t>(node)) {
+        fgReplicas.resize(static_cast<std::size_t>(node) + 1);
+    }
+    auto& replica = fgReplicas[static_cast<std::size_t>(node)];
+    if (!replica) {
+        // Allocated and written by this (pinned) thread: first touch puts
+        // the pages on its node
+        replica = std::make_unique<const std::vector<MarleyEventData>>(fgEvents);
+        G4cout << "PrimaryGeneratorAction: event cache replicated on NUMA node "
+               << node << G4endl;
+    }
+    fgLocalEvents = replica.get();
+}
+
 PrimaryGeneratorAction::PrimaryGeneratorAction()
     : G4VUserPrimaryGeneratorAction()
 {
-    if (fgEvents.empty()) {
+    if (fgEvents.empty() && !fgAr39Mode) {
         throw std::runtime_error(
             "PrimaryGeneratorAction: no events loaded. "
             "Call PrimaryGeneratorAction::LoadEvents() first.");
     }
 }
 
+void PrimaryGeneratorAction::BeginRun(G4int runID)
+{
+    // The first thread to start a run fixes its base, before any of its
+    // events can have been generated
+    std::lock_guard<std::mutex> lock(fgRunMutex);
+    if (runID != fgBaseRunID) {
+        fgBaseRunID = runID;
+        fgRunBase   = fgNextEvent;
+    }
+}
+
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
-    // Pick the next event (wraps around if more Geant4 events than entries).
-    const int idx = fgNextEvent.fetch_add(1)
-                    % static_cast<int>(fgEvents.size());
-    const auto& ev = fgEvents[static_cast<size_t>(idx)];
-
-    // Randomise the interaction vertex uniformly within the TPC (2×10×10 m).
-    // MARLEY momenta are already in MeV, matching Geant4 internal units.
-    G4double halfX  = 1.0 * m;
-    G4double halfYZ = 5.0 * m;
-    G4double vx = (2.0 * G4UniformRand() - 1.0) * halfX;
-    G4double vy = (2.0 * G4UniformRand() - 1.0) * halfYZ;
-    G4double vz = (2.0 * G4UniformRand() - 1.0) * halfYZ;
-    auto* vertex = new G4PrimaryVertex(vx, vy, vz, 0.);
+    // The global index fixes both the MARLEY event and the random streams,
+    // independent of which thread runs the event
+    const int global = fgRunBase + anEvent->GetEventID();
+    int generated = fgNextEvent;
+    while (generated < global + 1
+           && !fgNextEvent.compare_exchange_weak(generated, global + 1)) {}
+    RandomStreams::BeginEvent(static_cast<std::uint64_t>(global));
+
+    // Replay: continue from the recorded engine state of this event
+    if (EventCost::IsReplaying()) {
+        EventCost::RestoreEngine();
+    }
+    if (EventCost::IsEnabled()) {
+        EventCost::BeginEvent(static_cast<std::uint64_t>(global));
+    }
+
+    // Place the interaction vertex within the TPC (2×10×10 m) with the
+    // configured sampler.  MARLEY momenta are already in MeV, matching
+    // Geant4 internal units.
+    auto& random = RandomStreams::Get(RandomStreams::kVertex);
+    G4double vx = 0., vy = 0., vz = 0., stratumWeight = 1.;
+    G4int    stratum = 0;
+    VertexSampler::Sample(static_cast<std::uint64_t>(global), random,
+                          vx, vy, vz, stratum, stratumWeight);
+    // In burst mode the interaction happens at its time within the burst;
+    // a replay takes the recorded time, as its run holds this event alone.
+    G4double t0 = 0.;
+    if (EventCost::IsReplaying()) {
+        t0 = EventCost::GetReplayT0();
+    } else if (BurstReadout::IsEnabled()) {
+        t0 = BurstReadout::GetInteractionTime(anEvent->GetEventID());
+    }
+    auto* vertex = new G4PrimaryVertex(vx, vy, vz, t0);
+
+    if (fgAr39Mode) {
+        // One isotropic beta electron per event
+        auto& decay = RandomStreams::Get(RandomStreams::kDecay);
+        const G4double cosTheta = 2.0 * decay.Flat() - 1.0;
+        const G4double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+        const G4double phi      = twopi * decay.Flat();
+        auto* electron = new G4PrimaryParticle(11);
+        electron->SetKineticEnergy(SampleAr39Energy(decay));
+        electron->SetMomentumDirection(G4ThreeVector(sinTheta * std::cos(phi),
+                                                     sinTheta * std::sin(phi),
+                                                     cosTheta));
+        vertex->SetPrimary(electron);
+        anEvent->AddPrimaryVertex(vertex);
+        anEvent->SetUserInformation(
+            new EventInformation(global, -1, 0., stratum, stratumWeight));
+        return;
+    }
+
+    // Pick the event (wraps around if more Geant4 events than entries),
+    // from this node's copy of the cache if there is one.
+    const auto& events = fgLocalEvents ? *fgLocalEvents : fgEvents;
+    const int idx = global % static_cast<int>(events.size());
+    const auto& ev = events[static_cast<size_t>(idx)];
 
     for (int j = 0; j < ev.nParticles; ++j) {
         auto* particle = new G4PrimaryParticle(ev.pdg[j]);
@@ -112,6 +254,8 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
     }
 
     anEvent->AddPrimaryVertex(vertex);
+    anEvent->SetUserInformation(new EventInformation(global, idx, ev.nuEnergy,
+                                                     stratum, stratumWeight));
 }
 
 } // namespace ToyLArTPC
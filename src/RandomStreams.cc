@@ -0,0 +1,120 @@
+/// \file RandomStreams.cc
+/// \brief Implementation of the ToyLArTPC::RandomStream and
+///        ToyLArTPC::RandomStreams classes.
+
+#include "RandomStreams.hh"
+
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace ToyLArTPC {
+
+namespace {
+
+// Philox4x32 multipliers and Weyl key increments
+constexpr std::uint32_t kMultiplier0 = 0xD2511F53u;
+constexpr std::uint32_t kMultiplier1 = 0xCD9E8D57u;
+constexpr std::uint32_t kWeyl0       = 0x9E3779B9u;
+constexpr std::uint32_t kWeyl1       = 0xBB67AE85u;
+constexpr int           kRounds      = 10;
+
+/// Two 32-bit words to a double in (0, 1).
+inline G4double ToUniform(std::uint32_t hi, std::uint32_t lo)
+{
+    const std::uint64_t bits = (static_cast<std::uint64_t>(hi) << 32) | lo;
+    return (static_cast<G4double>(bits >> 11) + 0.5) * 0x1.0p-53;
+}
+
+thread_local std::array<RandomStream, RandomStreams::kNStreams> tStreams;
+
+} // anonymous namespace
+
+std::uint64_t RandomStreams::fgSeed = 1;
+
+void RandomStream::Reset(std::uint64_t seed, std::uint64_t event, std::uint32_t stream)
+{
+    fKey[0]   = static_cast<std::uint32_t>(seed);
+    fKey[1]   = static_cast<std::uint32_t>(seed >> 32);
+    fEvent[0] = static_cast<std::uint32_t>(event);
+    fEvent[1] = static_cast<std::uint32_t>(event >> 32);
+    fStream   = stream;
+    fBlock    = 0;
+    fNext     = kBufferSize;
+}
+
+void RandomStream::Refill()
+{
+    // Counter block i = (fBlock + i, stream, event lo, event hi); every block
+    // yields four 32-bit words, i.e. two doubles.  Lanes are independent, so
+    // the round loop below vectorizes across blocks.
+    constexpr std::size_t kBlocks = kBufferSize / 2;
+    std::uint32_t x0[kBlocks], x1[kBlocks], x2[kBlocks], x3[kBlocks];
+    for (std::size_t i = 0; i < kBlocks; ++i) {
+        x0[i] = fBlock + static_cast<std::uint32_t>(i);
+        x1[i] = fStream;
+        x2[i] = fEvent[0];
+        x3[i] = fEvent[1];
+    }
+
+    std::uint32_t k0 = fKey[0], k1 = fKey[1];
+    for (int round = 0; round < kRounds; ++round) {
+        for (std::size_t i = 0; i < kBlocks; ++i) {
+            const std::uint64_t p0 = static_cast<std::uint64_t>(kMultiplier0) * x0[i];
+            const std::uint64_t p1 = static_cast<std::uint64_t>(kMultiplier1) * x2[i];
+            const std::uint32_t y0 = static_cast<std::uint32_t>(p1 >> 32) ^ x1[i] ^ k0;
+            const std::uint32_t y2 = static_cast<std::uint32_t>(p0 >> 32) ^ x3[i] ^ k1;
+            x1[i] = static_cast<std::uint32_t>(p1);
+            x3[i] = static_cast<std::uint32_t>(p0);
+            x0[i] = y0;
+            x2[i] = y2;
+        }
+        k0 += kWeyl0;
+        k1 += kWeyl1;
+    }
+
+    for (std::size_t i = 0; i < kBlocks; ++i) {
+        fBuffer[2 * i]     = ToUniform(x0[i], x1[i]);
+        fBuffer[2 * i + 1] = ToUniform(x2[i], x3[i]);
+    }
+    fBlock += static_cast<std::uint32_t>(kBlocks);
+    fNext   = 0;
+}
+
+G4long RandomStream::Poisson(G4double mean)
+{
+    if (mean <= 0.) return 0;
+
+    if (mean < 30.) {
+        // Multiply uniforms until the product drops below exp(-mean)
+        const G4double limit = std::exp(-mean);
+        G4long   k = 0;
+        G4double p = Flat();
+        while (p > limit) {
+            ++k;
+            p *= Flat();
+        }
+        return k;
+    }
+
+    // Large means: Gaussian approximation (Box-Muller)
+    const G4double gauss = std::sqrt(-2. * std::log(Flat()))
+                         * std::cos(twopi * Flat());
+    return std::max<G4long>(0, std::lround(mean + std::sqrt(mean) * gauss));
+}
+
+void RandomStreams::BeginEvent(std::uint64_t globalEventID)
+{
+    for (std::uint32_t s = 0; s < kNStreams; ++s) {
+        tStreams[s].Reset(fgSeed, globalEventID, s);
+    }
+}
+
+RandomStream& RandomStreams::Get(Stream s)
+{
+    return tStreams[s];
+}
+
+} // namespace ToyLArTPC
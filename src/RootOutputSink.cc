@@ -0,0 +1,91 @@
+/// \file RootOutputSink.cc
+/// \brief Implementation of the ToyLArTPC::RootOutputSink class.
+
+#include "RootOutputSink.hh"
+
+#include "G4AnalysisManager.hh"
+
+namespace ToyLArTPC {
+
+RootOutputSink::RootOutputSink()
+{
+    auto analysisManager = G4AnalysisManager::Instance();
+    analysisManager->SetDefaultFileType("root");
+    analysisManager->SetVerboseLevel(1);
+}
+
+G4int RootOutputSink::CreateTable(const G4String& name, const G4String& title)
+{
+    return G4AnalysisManager::Instance()->CreateNtuple(name, title);
+}
+
+void RootOutputSink::CreateIColumn(const G4String& name)
+{
+    G4AnalysisManager::Instance()->CreateNtupleIColumn(name);
+}
+
+void RootOutputSink::CreateFColumn(const G4String& name)
+{
+    G4AnalysisManager::Instance()->CreateNtupleFColumn(name);
+}
+
+void RootOutputSink::CreateDColumn(const G4String& name)
+{
+    G4AnalysisManager::Instance()->CreateNtupleDColumn(name);
+}
+
+void RootOutputSink::CreateIColumn(const G4String& name, std::vector<G4int>& values)
+{
+    G4AnalysisManager::Instance()->CreateNtupleIColumn(name, values);
+}
+
+void RootOutputSink::CreateFColumn(const G4String& name, std::vector<G4float>& values)
+{
+    G4AnalysisManager::Instance()->CreateNtupleFColumn(name, values);
+}
+
+void RootOutputSink::FinishTable()
+{
+    G4AnalysisManager::Instance()->FinishNtuple();
+}
+
+void RootOutputSink::FillIColumn(G4int table, G4int column, G4int value)
+{
+    G4AnalysisManager::Instance()->FillNtupleIColumn(table, column, value);
+}
+
+void RootOutputSink::FillFColumn(G4int table, G4int column, G4float value)
+{
+    G4AnalysisManager::Instance()->FillNtupleFColumn(table, column, value);
+}
+
+void RootOutputSink::FillDColumn(G4int table, G4int column, G4double value)
+{
+    G4AnalysisManager::Instance()->FillNtupleDColumn(table, column, value);
+}
+
+void RootOutputSink::DoAddRow(G4int table)
+{
+    G4AnalysisManager::Instance()->AddNtupleRow(table);
+}
+
+G4String RootOutputSink::DoOpen(const G4String& baseName)
+{
+    // The analysis manager adds the same _t<k> suffix on workers
+    G4AnalysisManager::Instance()->OpenFile(baseName);
+    return ThreadFileName(baseName, ".root");
+}
+
+void RootOutputSink::DoFlush()
+{
+    G4AnalysisManager::Instance()->Write();
+}
+
+void RootOutputSink::DoClose()
+{
+    auto analysisManager = G4AnalysisManager::Instance();
+    analysisManager->Write();
+    analysisManager->CloseFile();
+}
+
+} // namespace ToyLArTPC
@@ -2,38 +2,132 @@
 /// \brief Implementation of the ToyLArTPC::RunAction class.
 
 #include "RunAction.hh"
+#include "ChargeReadout.hh"
+#include "Checkpoint.hh"
+#include "EventAction.hh"
+#include "EventCost.hh"
+#include "EventIndex.hh"
+#include "MemoryMonitor.hh"
+#include "OutputSink.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RunAggregates.hh"
+#include "Trigger.hh"
 
-#include "G4AnalysisManager.hh"
 #include "G4Run.hh"
+#include "G4Threading.hh"
 
 namespace ToyLArTPC {
 
-RunAction::RunAction()
+G4String RunAction::fgOutputFileName = "ToyLArTPC";
+G4bool   RunAction::fgSparseOutput   = false;
+G4bool   RunAction::fgArrivalTimes   = false;
+
+RunAction::RunAction(EventAction* eventAction)
+    : fEventAction(eventAction)
 {
-    auto analysisManager = G4AnalysisManager::Instance();
-    analysisManager->SetDefaultFileType("root");
-    analysisManager->SetVerboseLevel(1);
+    // Aggregate-only runs write no per-event rows at all
+    if (RunAggregates::IsEnabled()) return;
+
+    auto sink = OutputSink::Instance();
+
+    // Create ntuple (id = kCountsNtuple)
+    sink->CreateTable("PhotonCounts", "Photon counts per sensor per event");
+    if (fgSparseOutput) {
+        // Zero-suppressed: n_tiles (tile, count) pairs for the lit tiles only
+        sink->CreateIColumn("event_id");
+        sink->CreateIColumn("triggered");
+        sink->CreateIColumn("weight");
+        sink->CreateIColumn("n_tiles");
+        sink->CreateIColumn("total");
+        sink->CreateIColumn("tile",  fEventAction->GetSparseTiles());
+        sink->CreateIColumn("count", fEventAction->GetSparseCounts());
+    } else {
+        for (G4int i = 0; i < kNTiles; ++i) {
+            G4String colName = "sensor_" + std::to_string(i);
+            sink->CreateIColumn(colName);
+        }
+        sink->CreateIColumn("event_id");
+        if (Trigger::IsEnabled()) {
+            // Needed to tell prescaled events apart and to re-weight them
+            sink->CreateIColumn("triggered");
+            sink->CreateIColumn("weight");
+        }
+    }
+    if (fgArrivalTimes) {
+        sink->CreateIColumn("arrival_time", fEventAction->GetArrivalTimes());
+    }
+    sink->FinishTable();
+
+    // Generator truth of every simulated event, written or not, so that
+    // efficiency studies need not re-simulate (id = kTruthNtuple)
+    sink->CreateTable("Truth", "Generator truth per simulated event");
+    sink->CreateIColumn("event_id");
+    sink->CreateIColumn("marley_index");
+    sink->CreateDColumn("nu_energy");
+    sink->CreateDColumn("vertex_x");
+    sink->CreateDColumn("vertex_y");
+    sink->CreateDColumn("vertex_z");
+    sink->CreateDColumn("t0");
+    sink->CreateIColumn("stratum");
+    sink->CreateDColumn("stratum_weight");
+    sink->CreateDColumn("edep");   // -1 unless ChargeSD::IsNeeded()
+    sink->CreateIColumn("n_photons");
+    sink->CreateIColumn("written");
+    sink->CreateDColumn("sim_time");
+    sink->FinishTable();
 
-    // Create ntuple (id = 0)
-    analysisManager->CreateNtuple("PhotonCounts", "Photon counts per sensor per event");
-    for (G4int i = 0; i < kNTiles; ++i) {
-        G4String colName = "sensor_" + std::to_string(i);
-        analysisManager->CreateNtupleIColumn(colName);
+    // Zero-suppressed charge image, one row per PhotonCounts row
+    // (id = kChargeNtuple)
+    if (ChargeReadout::IsEnabled()) {
+        auto& image = fEventAction->GetChargeImage();
+        sink->CreateTable("ChargeHits", "Charge per (plane, channel, tick) per event");
+        sink->CreateIColumn("event_id");
+        sink->CreateIColumn("n_cells");
+        sink->CreateIColumn("plane",   image.plane);
+        sink->CreateIColumn("channel", image.channel);
+        sink->CreateIColumn("tick",    image.tick);
+        sink->CreateFColumn("charge",  image.charge);
+        sink->FinishTable();
     }
-    analysisManager->FinishNtuple();
 }
 
-void RunAction::BeginOfRunAction(const G4Run* /*run*/)
+void RunAction::BeginOfRunAction(const G4Run* run)
 {
-    auto analysisManager = G4AnalysisManager::Instance();
-    analysisManager->OpenFile("ToyLArTPC");
+    PrimaryGeneratorAction::BeginRun(run->GetRunID());
+
+    if (!RunAggregates::IsEnabled()) {
+        OutputSink::Instance()->Open(fgOutputFileName);
+    }
+
+    fEventAction->ResetRunCounters();
 }
 
 void RunAction::EndOfRunAction(const G4Run* /*run*/)
 {
-    auto analysisManager = G4AnalysisManager::Instance();
-    analysisManager->Write();
-    analysisManager->CloseFile();
+    if (!RunAggregates::IsEnabled()) {
+        auto sink = OutputSink::Instance();
+        sink->Close();
+        sink->EndOfThreadRun();
+
+        // Where this thread's events went, for the run's event index
+        if (!fEventAction->GetIndexEntries().empty()) {
+            EventIndex::AddThread(sink->GetFileName(), fEventAction->GetIndexEntries());
+        }
+    }
+
+    if (MemoryMonitor::IsEnabled()) {
+        MemoryMonitor::EndOfThreadRun();
+    }
+    if (EventCost::IsEnabled()) {
+        EventCost::EndOfThreadRun();
+    }
+
+    // Everything written by this thread is now on disk
+    if (Checkpoint::IsEnabled()) {
+        Checkpoint::RecordFlush(G4Threading::G4GetThreadId(),
+                                fEventAction->GetEventsProcessed(),
+                                fEventAction->GetLastEventID());
+    }
 }
 
 } // namespace ToyLArTPC
@@ -0,0 +1,205 @@
+/// \file RunAggregates.cc
+/// \brief Implementation of the ToyLArTPC::RunAggregates class.
+
+#include "RunAggregates.hh"
+
+#include "TFile.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TH3D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace DP = DetectorParameters;
+
+namespace {
+
+/// Octave bin of a photon count: 0 for none, k for [2^(k-1), 2^k).
+inline G4int CountBin(G4int n)
+{
+    if (n <= 0) return 0;
+    return std::min(1 + std::ilogb(static_cast<G4double>(n)),
+                    RunAggregates::kCountBins - 1);
+}
+
+inline G4int Bin(G4double v, G4double fullLength, G4int nBins)
+{
+    const auto bin = static_cast<G4int>((v / fullLength + 0.5) * nBins);
+    return std::clamp(bin, 0, nBins - 1);
+}
+
+} // anonymous namespace
+
+G4bool RunAggregates::fgEnabled = false;
+
+G4ThreadLocal RunAggregates::Accumulator* RunAggregates::fgThreadAccumulator = nullptr;
+
+std::mutex                               RunAggregates::fgMutex;
+std::vector<RunAggregates::Accumulator*> RunAggregates::fgRegistry;
+
+void RunAggregates::Accumulator::Merge(const Accumulator& other)
+{
+    events += other.events;
+    for (G4int i = 0; i < kNTiles; ++i) {
+        tileSum[i]   += other.tileSum[i];
+        tileSumSq[i] += other.tileSumSq[i];
+        tileFired[i] += other.tileFired[i];
+        for (G4int k = 0; k < kCountBins; ++k) tileCounts[i][k] += other.tileCounts[i][k];
+    }
+    for (G4int k = 0; k < kCountBins; ++k) total[k] += other.total[k];
+    for (G4int k = 0; k < kNTimes; ++k)    arrival[k] += other.arrival[k];
+    for (G4int v = 0; v < kVertexBins; ++v) {
+        vertexEvents[v] += other.vertexEvents[v];
+        vertexLight[v]  += other.vertexLight[v];
+        vertexFired[v]  += other.vertexFired[v];
+    }
+}
+
+G4int RunAggregates::VertexBin(G4double x, G4double y, G4double z)
+{
+    return (Bin(x, DP::kTpcX, kVertexBinsX) * kVertexBinsY
+            + Bin(y, DP::kTpcY, kVertexBinsY)) * kVertexBinsZ
+         + Bin(z, DP::kTpcZ, kVertexBinsZ);
+}
+
+RunAggregates::Accumulator& RunAggregates::ThreadAccumulator()
+{
+    if (!fgThreadAccumulator) {
+        fgThreadAccumulator = new Accumulator;   // aligned new (C++17)
+        std::lock_guard<std::mutex> lock(fgMutex);
+        fgRegistry.push_back(fgThreadAccumulator);
+    }
+    return *fgThreadAccumulator;
+}
+
+void RunAggregates::Fill(const std::vector<G4int>& counts, G4int weight,
+                         G4double x, G4double y, G4double z)
+{
+    auto& acc = ThreadAccumulator();
+    const G4double w = weight;
+
+    G4int total = 0, fired = 0;
+    for (G4int i = 0; i < kNTiles; ++i) {
+        const G4int n = counts[i];
+        acc.tileSum[i]   += w * n;
+        acc.tileSumSq[i] += w * n * static_cast<G4double>(n);
+        acc.tileCounts[i][CountBin(n)] += w;
+        if (n > 0) {
+            acc.tileFired[i] += w;
+            ++fired;
+        }
+        total += n;
+    }
+    acc.events += w;
+    acc.total[CountBin(total)] += w;
+
+    const G4int v = VertexBin(x, y, z);
+    acc.vertexEvents[v] += w;
+    acc.vertexLight[v]  += w * total;
+    acc.vertexFired[v]  += w * fired;
+}
+
+void RunAggregates::FillArrivalTime(G4double time, G4int weight)
+{
+    ThreadAccumulator().arrival[DP::TimeBin(time)] += weight;
+}
+
+G4double RunAggregates::Write(const std::string& file)
+{
+    Accumulator run;
+    {
+        // Workers are idle between runs: their accumulators are stable
+        std::lock_guard<std::mutex> lock(fgMutex);
+        for (auto* acc : fgRegistry) {
+            run.Merge(*acc);
+            *acc = Accumulator();
+        }
+    }
+
+    // --- Per-tile moments and occupancy ---
+    TH1D mean("tile_mean", "Mean photons per event;tile;photons", kNTiles, -0.5, kNTiles - 0.5);
+    TH1D rms("tile_rms", "RMS of photons per event;tile;photons", kNTiles, -0.5, kNTiles - 0.5);
+    TH1D occupancy("tile_occupancy", "Fraction of events with light;tile;fraction",
+                   kNTiles, -0.5, kNTiles - 0.5);
+
+    // Octave edges 0, 1, 2, 4, ... shared by the count histograms
+    std::vector<G4double> countEdges(kCountBins + 1, 0.);
+    for (G4int k = 1; k <= kCountBins; ++k) countEdges[k] = std::ldexp(1., k - 1);
+    TH2D counts("tile_counts", "Photons per event;tile;photons",
+                kNTiles, -0.5, kNTiles - 0.5, kCountBins, countEdges.data());
+    TH1D total("total_light", "Total photons per event;photons;events",
+               kCountBins, countEdges.data());
+
+    for (G4int i = 0; i < kNTiles; ++i) {
+        if (run.events <= 0.) break;
+        const G4double m = run.tileSum[i] / run.events;
+        mean.SetBinContent(i + 1, m);
+        rms.SetBinContent(i + 1, std::sqrt(std::max(0., run.tileSumSq[i] / run.events - m * m)));
+        occupancy.SetBinContent(i + 1, run.tileFired[i] / run.events);
+        for (G4int k = 0; k < kCountBins; ++k) {
+            counts.SetBinContent(i + 1, k + 1, run.tileCounts[i][k]);
+        }
+    }
+    for (G4int k = 0; k < kCountBins; ++k) total.SetBinContent(k + 1, run.total[k]);
+    mean.SetEntries(run.events);
+    rms.SetEntries(run.events);
+    occupancy.SetEntries(run.events);
+    counts.SetEntries(run.events);
+    total.SetEntries(run.events);
+
+    // --- Arrival-time profile, edges as DetectorParameters::TimeBin ---
+    std::vector<G4double> timeEdges(kNTimes + 1, 0.);
+    for (G4int k = 1; k <= kNTimes; ++k) {
+        timeEdges[k] = DP::kTimeBinOrigin
+                     * std::pow(10., static_cast<G4double>(k - 1) / DP::kTimeBinsPerDecade);
+    }
+    TH1D arrival("arrival_time", "Photon arrival time;t [ns];photons",
+                 kNTimes, timeEdges.data());
+    for (G4int k = 0; k < kNTimes; ++k) arrival.SetBinContent(k + 1, run.arrival[k]);
+
+    // --- Light and occupancy versus vertex ---
+    const G4double hx = 0.5 * DP::kTpcX, hy = 0.5 * DP::kTpcY, hz = 0.5 * DP::kTpcZ;
+    TH3D events("vertex_events", "Events;x [mm];y [mm];z [mm]",
+                kVertexBinsX, -hx, hx, kVertexBinsY, -hy, hy, kVertexBinsZ, -hz, hz);
+    TH3D light("vertex_light", "Mean total photons;x [mm];y [mm];z [mm]",
+               kVertexBinsX, -hx, hx, kVertexBinsY, -hy, hy, kVertexBinsZ, -hz, hz);
+    TH3D fired("vertex_occupancy", "Mean fraction of tiles with light;x [mm];y [mm];z [mm]",
+               kVertexBinsX, -hx, hx, kVertexBinsY, -hy, hy, kVertexBinsZ, -hz, hz);
+    for (G4int ix = 0; ix < kVertexBinsX; ++ix) {
+        for (G4int iy = 0; iy < kVertexBinsY; ++iy) {
+            for (G4int iz = 0; iz < kVertexBinsZ; ++iz) {
+                const G4int v = (ix * kVertexBinsY + iy) * kVertexBinsZ + iz;
+                const G4double n = run.vertexEvents[v];
+                events.SetBinContent(ix + 1, iy + 1, iz + 1, n);
+                if (n <= 0.) continue;
+                light.SetBinContent(ix + 1, iy + 1, iz + 1, run.vertexLight[v] / n);
+                fired.SetBinContent(ix + 1, iy + 1, iz + 1, run.vertexFired[v] / (n * kNTiles));
+            }
+        }
+    }
+
+    // Histograms were made before the file, so it does not own them
+    TFile out(file.c_str(), "RECREATE");
+    if (out.IsZombie()) {
+        throw std::runtime_error("RunAggregates: cannot create " + file);
+    }
+    mean.Write();
+    rms.Write();
+    occupancy.Write();
+    counts.Write();
+    total.Write();
+    arrival.Write();
+    events.Write();
+    light.Write();
+    fired.Write();
+    out.Close();
+
+    G4cout << "RunAggregates: " << run.events << " events summarized in " << file << G4endl;
+    return run.events;
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,168 @@
+/// \file SharedMemoryStream.cc
+/// \brief Implementation of the ToyLArTPC::SharedMemoryStream class.
+
+#include "SharedMemoryStream.hh"
+#include "EventInformation.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace ToyLArTPC {
+
+SharedRing::Header* SharedMemoryStream::fgHeader = nullptr;
+SharedRing::Slot*   SharedMemoryStream::fgSlots  = nullptr;
+std::size_t         SharedMemoryStream::fgSize   = 0;
+std::string         SharedMemoryStream::fgName;
+G4bool              SharedMemoryStream::fgTruth  = false;
+
+std::mutex    SharedMemoryStream::fgMutex;
+G4double      SharedMemoryStream::fgWaitSeconds = 0.;
+G4bool        SharedMemoryStream::fgStalled     = false;
+std::uint64_t SharedMemoryStream::fgStalledAt   = 0;
+
+void SharedMemoryStream::Open(const std::string& name, G4int nSlots, Policy policy,
+                              G4bool truth)
+{
+    std::uint32_t slots = 1;
+    while (slots < static_cast<std::uint32_t>(std::max(nSlots, 1))) slots <<= 1;
+
+    // A segment left behind by a killed job is replaced
+    ::shm_unlink(name.c_str());
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("SharedMemoryStream: cannot create " + name);
+    }
+    const std::size_t size = SharedRing::SegmentSize(slots);
+    void* map = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("SharedMemoryStream: cannot map " + name);
+    }
+
+    // The segment starts zeroed: every slot sequence is 0, nothing published
+    auto header = new (map) SharedRing::Header;
+    std::memcpy(header->magic, SharedRing::kMagic, sizeof(SharedRing::kMagic));
+    header->nSlots     = slots;
+    header->recordSize = sizeof(SharedRing::Record);
+    header->policy     = (policy == Policy::Drop) ? SharedRing::kDrop : SharedRing::kBlock;
+    header->written.store(0);
+    header->consumed.store(0);
+    header->dropped.store(0);
+    header->closed.store(0);
+    header->readers.store(0);
+    fgSlots = SharedRing::GetSlots(header);
+    for (std::uint32_t k = 0; k < slots; ++k) {
+        new (&fgSlots[k].sequence) std::atomic<std::uint64_t>(0);
+    }
+    // Readers check the version last written, once the layout is complete
+    std::atomic_thread_fence(std::memory_order_release);
+    header->version = SharedRing::kVersion;
+
+    fgHeader      = header;
+    fgSize        = size;
+    fgName        = name;
+    fgTruth       = truth;
+    fgWaitSeconds = 0.;
+    fgStalled     = false;
+
+    G4cout << "SharedMemoryStream: publishing to " << name << " (" << slots << " slots, "
+           << (policy == Policy::Drop ? "drop" : "block") << " when full)" << G4endl;
+}
+
+void SharedMemoryStream::Publish(const G4Event* event, const std::vector<G4int>& counts,
+                                 G4bool triggered, G4int weight, G4int total)
+{
+    std::lock_guard<std::mutex> lock(fgMutex);
+    auto header = fgHeader;
+    const std::uint64_t n     = header->written.load(std::memory_order_relaxed);
+    const std::uint64_t slots = header->nSlots;
+
+    // Full: the consumer has not handed back the slot of event n - nSlots.
+    // Waiting only makes sense while a consumer is attached and reading;
+    // otherwise the event is dropped and counted, as under kDrop.
+    std::uint64_t consumed = header->consumed.load(std::memory_order_acquire);
+    if (fgStalled && consumed != fgStalledAt) fgStalled = false;
+    if (n - consumed >= slots) {
+        if (header->policy == SharedRing::kDrop || fgStalled
+            || header->readers.load(std::memory_order_acquire) == 0) {
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const G4double start = SharedRing::Now();
+        G4double progress = start;
+        while (n - consumed >= slots) {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+            const std::uint64_t now = header->consumed.load(std::memory_order_acquire);
+            if (now != consumed) {
+                consumed = now;
+                progress = SharedRing::Now();
+            } else if (header->readers.load(std::memory_order_acquire) == 0
+                       || SharedRing::Now() - progress > kStallSeconds) {
+                // Detached, or attached but gone (killed readers never
+                // detach): drop until the consumer reads again
+                if (header->readers.load(std::memory_order_acquire) != 0) {
+                    G4cerr << "SharedMemoryStream: no event read from " << fgName << " for "
+                           << kStallSeconds << " s; dropping events until the consumer"
+                           << " catches up" << G4endl;
+                }
+                fgStalled   = true;
+                fgStalledAt = consumed;
+                fgWaitSeconds += SharedRing::Now() - start;
+                header->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        fgWaitSeconds += SharedRing::Now() - start;
+    }
+
+    // Fill the slot in place, then publish it
+    auto& slot   = fgSlots[n & (slots - 1)];
+    auto& record = slot.record;
+    const auto info = static_cast<const EventInformation*>(event->GetUserInformation());
+    record.event     = info ? info->GetGlobalID() : event->GetEventID();
+    record.triggered = triggered ? 1 : 0;
+    record.weight    = weight;
+    record.total     = total;
+    std::copy(counts.begin(), counts.begin() + DetectorParameters::kNTiles, record.counts);
+    record.hasTruth  = fgTruth ? 1 : 0;
+    if (fgTruth) {
+        const auto vertex = event->GetPrimaryVertex()->GetPosition();
+        record.nuEnergy  = static_cast<float>(info ? info->GetNuEnergy() : 0.);
+        record.vertex[0] = static_cast<float>(vertex.x());
+        record.vertex[1] = static_cast<float>(vertex.y());
+        record.vertex[2] = static_cast<float>(vertex.z());
+    }
+    record.published = SharedRing::Now();
+
+    slot.sequence.store(n + 1, std::memory_order_release);
+    header->written.store(n + 1, std::memory_order_release);
+}
+
+void SharedMemoryStream::Close()
+{
+    if (!fgHeader) return;
+    fgHeader->closed.store(1, std::memory_order_release);
+
+    G4cout << std::fixed << std::setprecision(2)
+           << "SharedMemoryStream: " << fgHeader->written.load() << " events published to "
+           << fgName << ", " << fgHeader->dropped.load() << " dropped, "
+           << fgWaitSeconds << " s waiting for the consumer"
+           << std::defaultfloat << G4endl;
+
+    ::munmap(fgHeader, fgSize);
+    ::shm_unlink(fgName.c_str());
+    fgHeader = nullptr;
+    fgSlots  = nullptr;
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,210 @@
+/// \file SimulationServer.cc
+/// \brief Implementation of the ToyLArTPC::SimulationServer class.
+
+#include "SimulationServer.hh"
+#include "EventIndex.hh"
+#include "OutputSink.hh"
+#include "PhotonSD.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RandomStreams.hh"
+#include "RunAction.hh"
+#include "RunAggregates.hh"
+
+#include "G4RunManager.hh"
+#include "Randomize.hh"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace ToyLArTPC {
+
+namespace {
+
+/// Write the whole string to a socket, retrying on short writes.
+bool SendAll(int fd, const std::string& text)
+{
+    std::size_t sent = 0;
+    while (sent < text.size()) {
+        const ssize_t n = ::write(fd, text.data() + sent, text.size() - sent);
+        if (n <= 0) return false;
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+SimulationServer::SimulationServer(G4RunManager* runManager)
+    : fRunManager(runManager)
+{}
+
+void SimulationServer::Serve(std::istream& in, std::ostream& out)
+{
+    std::string line;
+    bool quit = false;
+    while (!quit && std::getline(in, line)) {
+        if (line.empty()) continue;
+        out << HandleRequest(line, quit) << std::endl;
+    }
+}
+
+void SimulationServer::Serve(const std::string& socketPath)
+{
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(
+            "SimulationServer: socket path too long: " + socketPath);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    const int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error("SimulationServer: cannot create socket");
+    }
+
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+        || ::listen(listenFd, 1) < 0) {
+        ::close(listenFd);
+        throw std::runtime_error(
+            "SimulationServer: cannot listen on " + socketPath);
+    }
+
+    std::cout << "SimulationServer: listening on " << socketPath << std::endl;
+
+    bool quit = false;
+    while (!quit) {
+        const int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            // Interrupted, or the client gave up: just wait for the next one
+            const int error = errno;
+            if (error == EINTR || error == ECONNABORTED) continue;
+            // Anything else (e.g. out of descriptors) persists: back off
+            // rather than spin, and give up if it is not a resource limit
+            std::cerr << "SimulationServer: accept failed: " << std::strerror(error)
+                      << std::endl;
+            if (error != EMFILE && error != ENFILE && error != ENOBUFS && error != ENOMEM) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        // Split the byte stream into request lines.
+        std::string pending;
+        char buffer[4096];
+        ssize_t n = 0;
+        while (!quit && (n = ::read(clientFd, buffer, sizeof(buffer))) > 0) {
+            pending.append(buffer, static_cast<std::size_t>(n));
+            std::size_t eol = 0;
+            while (!quit && (eol = pending.find('\n')) != std::string::npos) {
+                const std::string line = pending.substr(0, eol);
+                pending.erase(0, eol + 1);
+                if (line.empty()) continue;
+                if (!SendAll(clientFd, HandleRequest(line, quit) + "\n")) {
+                    break;
+                }
+            }
+        }
+        ::close(clientFd);
+    }
+
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+}
+
+std::string SimulationServer::HandleRequest(const std::string& request,
+                                            bool& quit)
+{
+    const int jobID = fNextJobID++;
+    std::ostringstream response;
+    response << "job " << jobID << ' ';
+
+    if (request == "quit") {
+        quit = true;
+        response << "ok quit";
+        return response.str();
+    }
+
+    // --- Parse key=value tokens (nothing is applied unless all are valid) ---
+    G4int       nEvents = 0;
+    int         first   = -1;
+    long        seed    = -1;
+    std::string output;
+    G4double    eff     = -1.;
+
+    std::istringstream tokens(request);
+    std::string token;
+    try {
+        while (tokens >> token) {
+            const auto eq = token.find('=');
+            if (eq == std::string::npos) {
+                throw std::invalid_argument("malformed token '" + token + "'");
+            }
+            const std::string key   = token.substr(0, eq);
+            const std::string value = token.substr(eq + 1);
+
+            if (key == "n") {
+                nEvents = std::stoi(value);
+            } else if (key == "first") {
+                first = std::stoi(value);
+                if (first < 0) throw std::invalid_argument("first < 0");
+            } else if (key == "seed") {
+                seed = std::stol(value);
+                if (seed < 0) throw std::invalid_argument("seed < 0");
+            } else if (key == "output") {
+                output = value;
+            } else if (key == "efficiency") {
+                eff = std::stod(value);
+                if (eff < 0. || eff > 1.) {
+                    throw std::invalid_argument("efficiency outside [0, 1]");
+                }
+            } else {
+                throw std::invalid_argument("unknown key '" + key + "'");
+            }
+        }
+        if (nEvents <= 0) throw std::invalid_argument("n must be > 0");
+    } catch (const std::exception& e) {
+        response << "error " << e.what();
+        return response.str();
+    }
+
+    // --- Re-apply the run-time parameters (no geometry/physics rebuild) ---
+    if (first >= 0)      PrimaryGeneratorAction::SetNextEvent(first);
+    if (seed >= 0) {
+        RandomStreams::SetSeed(static_cast<std::uint64_t>(seed));
+        G4Random::setTheSeed(seed);
+    }
+    if (!output.empty()) RunAction::SetOutputFileName(output);
+    if (eff >= 0.)       PhotonSD::SetEfficiency(eff);
+
+    // --- Run the job on the resident kernel ---
+    const auto start = std::chrono::steady_clock::now();
+    fRunManager->BeamOn(nEvents);
+    const std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - start;
+    if (RunAggregates::IsEnabled()) {
+        // One summary per job; Write() resets the accumulators for the next
+        RunAggregates::Write(RunAction::GetOutputFileName() + "_aggregate.root");
+    } else {
+        EventIndex::Write(RunAction::GetOutputFileName() + ".index");
+        OutputSink::Report();
+    }
+
+    response << "ok events=" << nEvents
+             << " output=" << RunAction::GetOutputFileName()
+             << " wall_s=" << wall.count();
+    return response.str();
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,22 @@
+/// \file StackingAction.cc
+/// \brief Implementation of the ToyLArTPC::StackingAction class.
+
+#include "StackingAction.hh"
+#include "MemoryMonitor.hh"
+
+#include "G4OpticalPhoton.hh"
+#include "G4StackManager.hh"
+#include "G4Track.hh"
+
+namespace ToyLArTPC {
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+    if (track->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) {
+        // The new track is not on the stack yet
+        MemoryMonitor::RecordStackDepth(stackManager->GetNUrgentTrack() + 1);
+    }
+    return fUrgent;
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,139 @@
+/// \file ThreadAffinity.cc
+/// \brief Implementation of the ToyLArTPC::ThreadAffinity class.
+
+#include "ThreadAffinity.hh"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace {
+
+/// Parse a kernel CPU list such as "0-15,32-47".
+std::vector<G4int> ParseCpuList(const std::string& text)
+{
+    std::vector<G4int> cpus;
+    std::istringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.empty()) continue;
+        const auto dash = range.find('-');
+        G4int first = 0, last = 0;
+        try {
+            first = std::stoi(range.substr(0, dash));
+            last  = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("ThreadAffinity: bad CPU list '" + text + "'");
+        }
+        for (G4int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::string ReadLine(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+} // anonymous namespace
+
+std::vector<G4int> ThreadAffinity::fgCpuOrder;
+std::vector<G4int> ThreadAffinity::fgCpuNode;
+G4int              ThreadAffinity::fgNodes = 1;
+
+void ThreadAffinity::Configure(const std::string& order)
+{
+    // --- CPUs this process may use ---
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        throw std::runtime_error("ThreadAffinity: cannot read the process CPU mask");
+    }
+
+    // --- CPUs per NUMA node ---
+    std::vector<std::vector<G4int>> nodes;
+    for (G4int node = 0; ; ++node) {
+        const std::string list = ReadLine(
+            "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (list.empty()) break;
+        nodes.push_back(ParseCpuList(list));
+    }
+    if (nodes.empty()) {
+        std::vector<G4int> all;
+        for (G4int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) all.push_back(cpu);
+        }
+        nodes.push_back(all);
+    }
+
+    fgCpuNode.assign(CPU_SETSIZE, 0);
+    for (std::size_t node = 0; node < nodes.size(); ++node) {
+        auto& cpus = nodes[node];
+        cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&allowed](G4int cpu) {
+                       return cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed);
+                   }),
+                   cpus.end());
+        for (G4int cpu : cpus) fgCpuNode[cpu] = static_cast<G4int>(node);
+    }
+    fgNodes = static_cast<G4int>(nodes.size());
+
+    // --- Worker order ---
+    fgCpuOrder.clear();
+    if (order == "compact") {
+        for (const auto& cpus : nodes) {
+            fgCpuOrder.insert(fgCpuOrder.end(), cpus.begin(), cpus.end());
+        }
+    } else if (order == "scatter") {
+        for (std::size_t i = 0; ; ++i) {
+            bool any = false;
+            for (const auto& cpus : nodes) {
+                if (i < cpus.size()) {
+                    fgCpuOrder.push_back(cpus[i]);
+                    any = true;
+                }
+            }
+            if (!any) break;
+        }
+    } else {
+        for (G4int cpu : ParseCpuList(order)) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)) {
+                throw std::runtime_error(
+                    "ThreadAffinity: CPU " + std::to_string(cpu) + " is not available");
+            }
+            fgCpuOrder.push_back(cpu);
+        }
+    }
+    if (fgCpuOrder.empty()) {
+        throw std::runtime_error("ThreadAffinity: no CPUs for order '" + order + "'");
+    }
+
+    G4cout << "ThreadAffinity: " << fgNodes << " NUMA node(s), "
+           << fgCpuOrder.size() << " CPUs in '" << order << "' order" << G4endl;
+}
+
+G4int ThreadAffinity::PinWorker(G4int threadIndex)
+{
+    if (fgCpuOrder.empty() || threadIndex < 0) return -1;
+    const G4int cpu = fgCpuOrder[static_cast<std::size_t>(threadIndex) % fgCpuOrder.size()];
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        G4cerr << "ThreadAffinity: cannot pin worker " << threadIndex
+               << " to CPU " << cpu << G4endl;
+        return -1;
+    }
+    return fgCpuNode[cpu];
+}
+
+} // namespace ToyLArTPC
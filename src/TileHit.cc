@@ -0,0 +1,38 @@
+/// \file TileHit.cc
+/// \brief Implementation of the ToyLArTPC::TileHit class.
+
+#include "TileHit.hh"
+#include "DetectorParameters.hh"
+
+#include "G4Box.hh"
+#include "G4Colour.hh"
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
+#include "G4Transform3D.hh"
+#include "G4VVisManager.hh"
+#include "G4VisAttributes.hh"
+
+namespace ToyLArTPC {
+
+void TileHit::Draw()
+{
+    auto visManager = G4VVisManager::GetConcreteInstance();
+    if (!visManager || fCount <= 0) return;
+
+    using namespace DetectorParameters;
+
+    G4double x = 0., y = 0., z = 0.;
+    TileCentre(fTileID, x, y, z);
+
+    // Slightly thicker than the 1 mm tile so it shows in front of it.
+    G4Box box("TileHeat", 10. * kTileThickness, kTileHeight / 2, kTileLength / 2);
+
+    // Blue → red heat scale
+    G4VisAttributes attribs(G4Colour(fIntensity, 0.2, 1.0 - fIntensity, 0.9));
+    attribs.SetForceSolid(true);
+
+    visManager->Draw(box, attribs,
+                     G4Transform3D(G4RotationMatrix(), G4ThreeVector(x, y, z)));
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,51 @@
+/// \file TrackingAction.cc
+/// \brief Implementation of the ToyLArTPC::TrackingAction class.
+
+#include "TrackingAction.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Track.hh"
+#include "G4TrackingManager.hh"
+
+#include <algorithm>
+
+namespace ToyLArTPC {
+
+TrackingAction::TrackingAction(G4int photonStride, G4int maxPhotons)
+    : G4UserTrackingAction(),
+      fPhotonStride(std::max(photonStride, 1)),
+      fMaxPhotons(std::max(maxPhotons, 0))
+{}
+
+void TrackingAction::PreUserTrackingAction(const G4Track* track)
+{
+    fSavedStoreMode = fpTrackingManager->GetStoreTrajectory();
+    if (fSavedStoreMode == 0) return;
+    if (track->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition())
+        return;
+
+    // Reset the per-event cap when a new event starts
+    const G4int eventID =
+        G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+    if (eventID != fEventID) {
+        fEventID       = eventID;
+        fStoredPhotons = 0;
+    }
+
+    const bool sampled = (track->GetTrackID() % fPhotonStride) == 0;
+    const bool underCap = (fMaxPhotons == 0) || (fStoredPhotons < fMaxPhotons);
+    if (sampled && underCap) {
+        ++fStoredPhotons;
+    } else {
+        fpTrackingManager->SetStoreTrajectory(0);
+    }
+}
+
+void TrackingAction::PostUserTrackingAction(const G4Track* /*track*/)
+{
+    fpTrackingManager->SetStoreTrajectory(fSavedStoreMode);
+}
+
+} // namespace ToyLArTPC
@@ -0,0 +1,32 @@
+/// \file Trigger.cc
+/// \brief Implementation of the ToyLArTPC::Trigger class.
+
+#include "Trigger.hh"
+#include "RandomStreams.hh"
+
+namespace ToyLArTPC {
+
+TriggerSettings Trigger::fgSettings;
+
+G4bool Trigger::Passes(const std::vector<G4int>& counts,
+                       G4int& nFired, G4int& total)
+{
+    nFired = 0;
+    total  = 0;
+    for (G4int count : counts) {
+        total += count;
+        nFired += (count >= fgSettings.tileThreshold) ? 1 : 0;
+    }
+
+    if (!fgSettings.IsEnabled()) return true;
+    return nFired >= fgSettings.multiplicity
+           && total >= fgSettings.totalThreshold;
+}
+
+G4bool Trigger::KeepPrescaled()
+{
+    if (fgSettings.prescale <= 0) return false;
+    return RandomStreams::Get(RandomStreams::kPrescale).Flat() * fgSettings.prescale < 1.;
+}
+
+} // namespace ToyLArTPC
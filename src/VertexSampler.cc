@@ -0,0 +1,201 @@
+/// \file VertexSampler.cc
+/// \brief Implementation of the ToyLArTPC::VertexSampler class.
+
+#include "VertexSampler.hh"
+#include "DetectorParameters.hh"
+#include "RandomStreams.hh"
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace ToyLArTPC {
+
+namespace DP = DetectorParameters;
+
+namespace {
+
+/// Sobol direction numbers v_k = m_k << (32 - k) of the first three
+/// dimensions (Joe-Kuo): van der Corput, then the primitive polynomials
+/// x + 1 (m = 1) and x^2 + x + 1 (m = 1, 3).
+using Directions = std::array<std::array<std::uint32_t, 32>, 3>;
+
+const Directions& SobolDirections()
+{
+    static const Directions directions = [] {
+        Directions v{};
+        std::uint32_t m1[33] = { 0, 1 };
+        std::uint32_t m2[33] = { 0, 1, 3 };
+        for (int k = 2; k <= 32; ++k) m1[k] = (2 * m1[k - 1]) ^ m1[k - 1];
+        for (int k = 3; k <= 32; ++k) m2[k] = (2 * m2[k - 1]) ^ (4 * m2[k - 2]) ^ m2[k - 2];
+        for (int k = 1; k <= 32; ++k) {
+            v[0][k - 1] = 1u << (32 - k);
+            v[1][k - 1] = m1[k] << (32 - k);
+            v[2][k - 1] = m2[k] << (32 - k);
+        }
+        return v;
+    }();
+    return directions;
+}
+
+inline std::uint32_t ReverseBits(std::uint32_t x)
+{
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+/// Nested uniform (Owen) scramble of a 32-bit fraction: every bit is
+/// flipped depending on the bits above it, through a Laine-Karras
+/// permutation of the bit-reversed value (Burley 2020).
+inline std::uint32_t OwenScramble(std::uint32_t x, std::uint32_t seed)
+{
+    x = ReverseBits(x);
+    x += seed;
+    x ^= x * 0x6C50B47Cu;
+    x ^= x * 0xB82F1E52u;
+    x ^= x * 0xC7AFE638u;
+    x ^= x * 0x8D22F6E6u;
+    return ReverseBits(x);
+}
+
+/// Scramble seed of dimension `dim` for the job seed (SplitMix64 finalizer).
+inline std::uint32_t ScrambleSeed(std::uint64_t seed, G4int dim)
+{
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * static_cast<std::uint64_t>(dim + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<std::uint32_t>(z ^ (z >> 31));
+}
+
+} // anonymous namespace
+
+VertexSettings VertexSampler::fgSettings;
+
+void VertexSampler::Configure(const VertexSettings& settings)
+{
+    if (settings.sampler == VertexSettings::Sampler::Stratified
+        && (settings.nx < 1 || settings.ny < 1 || settings.nz < 1)) {
+        throw std::runtime_error("VertexSampler: need at least one voxel per axis");
+    }
+    if (settings.sampler == VertexSettings::Sampler::Grid
+        && (settings.gridX.empty() || settings.eventsPerPoint < 1)) {
+        throw std::runtime_error("VertexSampler: the grid sampler needs points and"
+                                 " at least one event per point");
+    }
+    fgSettings = settings;
+}
+
+void VertexSampler::LoadGrid(const std::string& file, VertexSettings& settings)
+{
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("VertexSampler: cannot open " + file);
+    }
+    settings.gridX.clear();
+    settings.gridY.clear();
+    settings.gridZ.clear();
+    settings.gridWeight.clear();
+
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto comment = line.find('#');
+        if (comment != std::string::npos) line.resize(comment);
+        std::istringstream fields(line);
+        G4double x = 0., y = 0., z = 0., w = 1.;
+        if (!(fields >> x)) continue;   // blank line
+        if (!(fields >> y >> z)) {
+            throw std::runtime_error("VertexSampler: bad grid line in " + file + ": " + line);
+        }
+        fields >> w;
+        if (std::abs(x) > 0.5 * DP::kTpcX || std::abs(y) > 0.5 * DP::kTpcY
+            || std::abs(z) > 0.5 * DP::kTpcZ || w <= 0.) {
+            throw std::runtime_error("VertexSampler: grid point outside the TPC or with"
+                                     " weight <= 0 in " + file + ": " + line);
+        }
+        settings.gridX.push_back(x);
+        settings.gridY.push_back(y);
+        settings.gridZ.push_back(z);
+        settings.gridWeight.push_back(w);
+    }
+    if (settings.gridX.empty()) {
+        throw std::runtime_error("VertexSampler: no grid points in " + file);
+    }
+
+    const G4double sum = std::accumulate(settings.gridWeight.begin(),
+                                         settings.gridWeight.end(), 0.);
+    for (auto& w : settings.gridWeight) w /= sum;
+    settings.sampler = VertexSettings::Sampler::Grid;
+
+    G4cout << "VertexSampler: " << settings.gridX.size() << " grid points from "
+           << file << G4endl;
+}
+
+G4double VertexSampler::Sobol(std::uint32_t index, G4int dim)
+{
+    const auto& v = SobolDirections()[dim];
+    std::uint32_t x = 0;
+    for (G4int k = 0; index != 0; ++k, index >>= 1) {
+        if (index & 1u) x ^= v[k];
+    }
+    x = OwenScramble(x, ScrambleSeed(RandomStreams::GetSeed(), dim));
+    return (static_cast<G4double>(x) + 0.5) * 0x1.0p-32;
+}
+
+void VertexSampler::Sample(std::uint64_t global, RandomStream& random,
+                           G4double& x, G4double& y, G4double& z,
+                           G4int& stratum, G4double& weight)
+{
+    // Unit-cube coordinates, mapped onto the TPC at the end
+    G4double u[3] = { 0.5, 0.5, 0.5 };
+    stratum = 0;
+    weight  = 1.;
+
+    switch (fgSettings.sampler) {
+        case VertexSettings::Sampler::Uniform:
+            for (auto& c : u) c = random.Flat();
+            break;
+
+        case VertexSettings::Sampler::Stratified: {
+            const auto nx = static_cast<std::uint64_t>(fgSettings.nx);
+            const auto ny = static_cast<std::uint64_t>(fgSettings.ny);
+            const auto nz = static_cast<std::uint64_t>(fgSettings.nz);
+            const std::uint64_t voxel = global % (nx * ny * nz);
+            u[0] = (static_cast<G4double>(voxel % nx) + random.Flat()) / nx;
+            u[1] = (static_cast<G4double>(voxel / nx % ny) + random.Flat()) / ny;
+            u[2] = (static_cast<G4double>(voxel / (nx * ny)) + random.Flat()) / nz;
+            stratum = static_cast<G4int>(voxel);
+            weight  = 1. / static_cast<G4double>(nx * ny * nz);
+            break;
+        }
+
+        case VertexSettings::Sampler::Sobol:
+            for (G4int d = 0; d < 3; ++d) {
+                u[d] = Sobol(static_cast<std::uint32_t>(global), d);
+            }
+            break;
+
+        case VertexSettings::Sampler::Grid: {
+            const std::uint64_t nPoints = fgSettings.gridX.size();
+            const std::uint64_t point =
+                global / static_cast<std::uint64_t>(fgSettings.eventsPerPoint) % nPoints;
+            x = fgSettings.gridX[point];
+            y = fgSettings.gridY[point];
+            z = fgSettings.gridZ[point];
+            stratum = static_cast<G4int>(point);
+            weight  = fgSettings.gridWeight[point];
+            return;
+        }
+    }
+
+    x = (u[0] - 0.5) * DP::kTpcX;
+    y = (u[1] - 0.5) * DP::kTpcY;
+    z = (u[2] - 0.5) * DP::kTpcZ;
+}
+
+} // namespace ToyLArTPC
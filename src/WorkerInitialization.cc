@@ -0,0 +1,50 @@
+/// \file WorkerInitialization.cc
+/// \brief Implementation of the ToyLArTPC::WorkerInitialization class.
+
+#include "WorkerInitialization.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "ThreadAffinity.hh"
+
+#include "G4Threading.hh"
+
+#include <chrono>
+
+namespace ToyLArTPC {
+
+std::atomic<G4double> WorkerInitialization::fgFirstInitialize{0.};
+std::atomic<G4double> WorkerInitialization::fgLastStart{0.};
+
+G4double WorkerInitialization::Now()
+{
+    const std::chrono::duration<double> t =
+        std::chrono::steady_clock::now().time_since_epoch();
+    return t.count();
+}
+
+void WorkerInitialization::WorkerInitialize() const
+{
+    // Pin first, so that everything this worker allocates from here on
+    // (geometry and allocator pools included) is first touched locally
+    if (ThreadAffinity::IsEnabled()) {
+        const G4int node = ThreadAffinity::PinWorker(G4Threading::G4GetThreadId());
+        if (ThreadAffinity::GetNumberOfNodes() > 1) {
+            PrimaryGeneratorAction::UseNodeReplica(node);
+        }
+    }
+
+    // Keep the earliest start time (0 means "not set yet").
+    const G4double now = Now();
+    G4double first = fgFirstInitialize.load();
+    while ((first == 0. || now < first)
+           && !fgFirstInitialize.compare_exchange_weak(first, now)) {}
+}
+
+void WorkerInitialization::WorkerStart() const
+{
+    // Keep the latest ready time.
+    const G4double now = Now();
+    G4double last = fgLastStart.load();
+    while (now > last && !fgLastStart.compare_exchange_weak(last, now)) {}
+}
+
+} // namespace ToyLArTPC
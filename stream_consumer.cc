@@ -0,0 +1,158 @@
+/// \file stream_consumer.cc
+/// \brief Example live consumer of the ToyLArTPC shared-memory stream.
+///
+/// Usage:
+///   ./StreamConsumer <name> [-wait <s>] [-max <events>] [-quiet]
+///
+/// Attaches to the ring published by `ToyLArTPC ... -stream <name>`
+/// (waiting for the simulation to create it), reads every event in place
+/// and hands its slot straight back.  Prints the event rate, the
+/// publish-to-read latency and the per-tile mean counts (prescaled events
+/// counted with their weight) once a second and at the end of the stream.
+/// A training or monitoring process would replace the body of the loop.
+
+#include "DetectorParameters.hh"
+#include "SharedRing.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace DP = ToyLArTPC::DetectorParameters;
+
+namespace {
+
+constexpr int kNTiles = DP::kNTiles;
+
+/// Weighted per-tile moments and handoff latency of the events read.
+struct Monitor {
+    double        sumW = 0.;
+    double        sum[kNTiles]  = {};
+    double        sum2[kNTiles] = {};
+    std::uint64_t events = 0;
+    double        latencySum = 0., latencyMax = 0.;
+
+    void Fill(const ToyLArTPC::SharedRing::Record& record, double latency)
+    {
+        const double w = record.weight;
+        sumW += w;
+        for (int i = 0; i < kNTiles; ++i) {
+            sum[i]  += w * record.counts[i];
+            sum2[i] += w * record.counts[i] * record.counts[i];
+        }
+        ++events;
+        latencySum += latency;
+        latencyMax  = std::max(latencyMax, latency);
+    }
+
+    void PrintTiles() const
+    {
+        std::cout << "Per-tile mean counts (RMS):\n" << std::fixed << std::setprecision(2);
+        for (int i = 0; i < kNTiles; ++i) {
+            const double mean = sumW > 0. ? sum[i] / sumW : 0.;
+            const double rms  = sumW > 0. ? std::sqrt(std::max(sum2[i] / sumW - mean * mean, 0.))
+                                          : 0.;
+            std::cout << "  tile " << std::setw(2) << i << "  " << std::setw(10) << mean
+                      << " (" << rms << ")\n";
+        }
+        std::cout << std::defaultfloat;
+    }
+};
+
+void PrintUsage()
+{
+    std::cerr << "Usage: StreamConsumer <name> [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  -wait <s>        Wait this long for the stream to appear (default 60)\n"
+              << "  -max <events>    Detach after this many events (default: whole stream)\n"
+              << "  -quiet           Print only the final summary\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-') {
+        PrintUsage();
+        return 1;
+    }
+    const std::string name = argv[1];
+    double        waitSeconds = 60.;
+    std::uint64_t maxEvents   = 0;   // 0 means the whole stream
+    bool          quiet       = false;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-wait" && i + 1 < argc) {
+            waitSeconds = std::stod(argv[++i]);
+        } else if (arg == "-max" && i + 1 < argc) {
+            maxEvents = std::stoull(argv[++i]);
+        } else if (arg == "-quiet") {
+            quiet = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // --- Attach, waiting for the simulation to create the segment ---
+    std::unique_ptr<ToyLArTPC::RingReader> reader;
+    const double deadline = ToyLArTPC::SharedRing::Now() + waitSeconds;
+    while (!reader) {
+        try {
+            reader = std::make_unique<ToyLArTPC::RingReader>(name);
+        } catch (const std::exception& e) {
+            if (ToyLArTPC::SharedRing::Now() > deadline) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    std::cout << "Attached to " << name << " (" << reader->GetNumberOfSlots()
+              << " slots)" << std::endl;
+
+    // --- Read until the writer closes the stream and it is drained ---
+    Monitor monitor;
+    const double start = ToyLArTPC::SharedRing::Now();
+    double nextReport  = start + 1.;
+    int    idle        = 0;
+    while (!reader->IsFinished() && (maxEvents == 0 || monitor.events < maxEvents)) {
+        if (const auto* record = reader->Next()) {
+            monitor.Fill(*record, ToyLArTPC::SharedRing::Now() - record->published);
+            reader->Release();
+            idle = 0;
+        } else if (++idle > 1000) {
+            // Nothing for a while: stop spinning
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        const double now = ToyLArTPC::SharedRing::Now();
+        if (!quiet && now >= nextReport) {
+            nextReport = now + 1.;
+            std::cout << std::fixed << std::setprecision(1)
+                      << "  " << monitor.events << " events, "
+                      << monitor.events / (now - start) << " events/s, latency "
+                      << std::setprecision(3)
+                      << (monitor.events ? 1.e3 * monitor.latencySum / monitor.events : 0.)
+                      << " ms mean, " << 1.e3 * monitor.latencyMax << " ms max, "
+                      << reader->GetDropped() << " dropped by the writer"
+                      << std::defaultfloat << std::endl;
+        }
+    }
+
+    const double elapsed = ToyLArTPC::SharedRing::Now() - start;
+    std::cout << std::fixed << std::setprecision(3)
+              << "Read " << monitor.events << " events in " << elapsed << " s; latency "
+              << (monitor.events ? 1.e3 * monitor.latencySum / monitor.events : 0.)
+              << " ms mean, " << 1.e3 * monitor.latencyMax << " ms max; "
+              << reader->GetDropped() << " dropped by the writer"
+              << std::defaultfloat << std::endl;
+    monitor.PrintTiles();
+    return 0;
+}
@@ -0,0 +1,432 @@
+/// \file summarize_outputs.cc
+/// \brief Standalone parallel summary of ToyLArTPC PhotonCounts outputs.
+///
+/// Usage:
+///   ./ToyLArTPCSummary [-j <nThreads>] [-o <summary.root>] [-chunk <entries>]
+///                      [-total-max <photons>] <ToyLArTPC_t0.root> [more.root ...]
+///
+/// Computes per-tile mean, variance and occupancy, the total-light spectrum
+/// and the light yield (photons per MeV of neutrino energy) versus vertex
+/// position.  Files are split into entry ranges that a pool of threads
+/// processes independently; every thread fills its own accumulator, and
+/// the accumulators are merged once at the end.  Only the branches that
+/// are needed are read, through a TTreeCache per range.  Prescaled rows
+/// are counted with their weight.  Truth rows are matched to the counts by
+/// entry, through a map built once per file.
+
+#include "DetectorParameters.hh"
+
+#include "TFile.h"
+#include "TH1D.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DP = ToyLArTPC::DetectorParameters;
+
+namespace {
+
+constexpr int kNTiles = DP::kNTiles;
+
+/// Weighted mean and variance, updated one value at a time and mergeable
+/// across threads (Welford/West update, Chan et al. combination).
+struct RunningStats {
+    double sumW = 0.;
+    double mean = 0.;
+    double m2   = 0.;   ///< sum of w * (x - mean)^2
+
+    void Add(double x, double w = 1.)
+    {
+        sumW += w;
+        const double delta = x - mean;
+        mean += (w / sumW) * delta;
+        m2   += w * delta * (x - mean);
+    }
+
+    void Merge(const RunningStats& other)
+    {
+        if (other.sumW <= 0.) return;
+        if (sumW <= 0.) { *this = other; return; }
+        const double total = sumW + other.sumW;
+        const double delta = other.mean - mean;
+        mean += delta * other.sumW / total;
+        m2   += other.m2 + delta * delta * sumW * other.sumW / total;
+        sumW  = total;
+    }
+
+    double Variance() const { return (sumW > 0.) ? m2 / sumW : 0.; }
+};
+
+/// Everything one thread accumulates; merged into the first one at the end.
+class SummaryAccumulator
+{
+public:
+    SummaryAccumulator(const std::string& suffix, double totalMax)
+        : fTotal(std::make_unique<TH1D>(("total_light" + suffix).c_str(),
+                                        "Total detected photons per event;photons;events",
+                                        1000, 0., totalMax)),
+          fYieldX(std::make_unique<TProfile>(("light_yield_vs_x" + suffix).c_str(),
+                                             "Light yield vs drift coordinate;x [mm];photons / MeV",
+                                             40, -DP::kTpcX / 2, DP::kTpcX / 2)),
+          fYieldYZ(std::make_unique<TProfile2D>(("light_yield_vs_yz" + suffix).c_str(),
+                                                "Light yield vs position on the walls;y [mm];z [mm]",
+                                                50, -DP::kTpcY / 2, DP::kTpcY / 2,
+                                                50, -DP::kTpcZ / 2, DP::kTpcZ / 2))
+    {
+        fTotal->SetDirectory(nullptr);
+        fYieldX->SetDirectory(nullptr);
+        fYieldYZ->SetDirectory(nullptr);
+    }
+
+    void Fill(const int* counts, double weight, bool hasTruth, double nuEnergy,
+              double x, double y, double z)
+    {
+        int total = 0;
+        for (int i = 0; i < kNTiles; ++i) {
+            fTileCounts[i].Add(counts[i], weight);
+            fTileOccupancy[i].Add(counts[i] > 0 ? 1. : 0., weight);
+            total += counts[i];
+        }
+        fTotalStats.Add(total, weight);
+        fTotal->Fill(total, weight);
+        fRows   += 1;
+        fEvents += weight;
+
+        if (hasTruth && nuEnergy > 0.) {
+            const double yield = total / nuEnergy;
+            fYieldX->Fill(x, yield, weight);
+            fYieldYZ->Fill(y, z, yield, weight);
+        }
+    }
+
+    void Merge(const SummaryAccumulator& other)
+    {
+        for (int i = 0; i < kNTiles; ++i) {
+            fTileCounts[i].Merge(other.fTileCounts[i]);
+            fTileOccupancy[i].Merge(other.fTileOccupancy[i]);
+        }
+        fTotalStats.Merge(other.fTotalStats);
+        fTotal->Add(other.fTotal.get());
+        fYieldX->Add(other.fYieldX.get());
+        fYieldYZ->Add(other.fYieldYZ.get());
+        fRows   += other.fRows;
+        fEvents += other.fEvents;
+    }
+
+    /// Write the merged summary to `path` and print it.
+    bool Write(const std::string& path) const
+    {
+        TH1D mean("tile_mean", "Mean photons per tile (error: RMS);tile;photons",
+                  kNTiles, -0.5, kNTiles - 0.5);
+        TH1D rms("tile_rms", "RMS of photons per tile;tile;photons",
+                 kNTiles, -0.5, kNTiles - 0.5);
+        TH1D occupancy("tile_occupancy", "Fraction of events with light on the tile;tile;fraction",
+                       kNTiles, -0.5, kNTiles - 0.5);
+        for (int i = 0; i < kNTiles; ++i) {
+            const double sigma = std::sqrt(fTileCounts[i].Variance());
+            mean.SetBinContent(i + 1, fTileCounts[i].mean);
+            mean.SetBinError(i + 1, sigma);
+            rms.SetBinContent(i + 1, sigma);
+            occupancy.SetBinContent(i + 1, fTileOccupancy[i].mean);
+        }
+
+        TFile out(path.c_str(), "RECREATE");
+        if (out.IsZombie() || !out.IsOpen()) {
+            std::cerr << "Error: Could not create " << path << std::endl;
+            return false;
+        }
+        mean.Write();
+        rms.Write();
+        occupancy.Write();
+        fTotal->Write("total_light");
+        fYieldX->Write("light_yield_vs_x");
+        fYieldYZ->Write("light_yield_vs_yz");
+        out.Close();
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << "Rows read: " << fRows << ", weighted events: " << fEvents << '\n'
+                  << "Total light: mean " << fTotalStats.mean
+                  << ", RMS " << std::sqrt(fTotalStats.Variance()) << " photons\n"
+                  << " tile      mean       RMS  occupancy\n";
+        for (int i = 0; i < kNTiles; ++i) {
+            std::cout << std::setw(5) << i
+                      << std::setw(10) << fTileCounts[i].mean
+                      << std::setw(10) << std::sqrt(fTileCounts[i].Variance())
+                      << std::setw(11) << fTileOccupancy[i].mean << '\n';
+        }
+        std::cout << std::defaultfloat << "Summary written to " << path << std::endl;
+        return true;
+    }
+
+private:
+    RunningStats fTileCounts[kNTiles];
+    RunningStats fTileOccupancy[kNTiles];
+    RunningStats fTotalStats;
+    long         fRows   = 0;
+    double       fEvents = 0.;
+
+    std::unique_ptr<TH1D>       fTotal;
+    std::unique_ptr<TProfile>   fYieldX;
+    std::unique_ptr<TProfile2D> fYieldYZ;
+};
+
+/// Minimal pool: runs fn(task, thread) for every task index, each thread
+/// taking the next unclaimed task.
+void RunTasks(std::size_t nTasks, unsigned nThreads,
+              const std::function<void(std::size_t, unsigned)>& fn)
+{
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < nThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (std::size_t task; (task = next.fetch_add(1)) < nTasks; ) fn(task, t);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+/// Entry range [first, last) of one file.
+struct Chunk {
+    std::size_t file;
+    Long64_t    first, last;
+};
+
+/// One input file: its PhotonCounts entries and, when it has a Truth
+/// sidecar, the Truth entry of every PhotonCounts entry.
+struct InputFile {
+    Long64_t              entries = -1;
+    std::vector<Long64_t> truthEntry;
+};
+
+/// Read the file header and map the written Truth rows onto PhotonCounts.
+/// A thread fills both tables in event order and only written events get
+/// a counts row, so the n-th written Truth row belongs to counts entry n
+/// (also after hadd, which appends both trees file by file).
+bool ScanFile(const std::string& path, InputFile& input)
+{
+    TFile file(path.c_str(), "READ");
+    auto* tree = file.IsZombie() ? nullptr : dynamic_cast<TTree*>(file.Get("PhotonCounts"));
+    if (!tree) {
+        std::cerr << "Error: No PhotonCounts tree in " << path << std::endl;
+        return false;
+    }
+    input.entries = tree->GetEntries();
+
+    auto* truth = dynamic_cast<TTree*>(file.Get("Truth"));
+    if (!truth) return true;   // Older file: truth columns in PhotonCounts
+    int written = 0;
+    truth->SetBranchStatus("*", false);
+    truth->SetBranchStatus("written", true);
+    truth->SetBranchAddress("written", &written);
+    const Long64_t nTruth = truth->GetEntries();
+    for (Long64_t entry = 0; entry < nTruth; ++entry) {
+        truth->GetEntry(entry);
+        if (written) input.truthEntry.push_back(entry);
+    }
+    if (static_cast<Long64_t>(input.truthEntry.size()) != input.entries) {
+        std::cerr << "Error: " << input.truthEntry.size() << " written Truth rows for "
+                  << input.entries << " PhotonCounts entries in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/// Read the rows of one chunk into `acc`.  Returns false on a bad file.
+bool ProcessChunk(const std::string& path, const InputFile& input, const Chunk& chunk,
+                  SummaryAccumulator& acc)
+{
+    TFile file(path.c_str(), "READ");
+    auto* tree = file.IsZombie() ? nullptr : dynamic_cast<TTree*>(file.Get("PhotonCounts"));
+    if (!tree) {
+        std::cerr << "Error: No PhotonCounts tree in " << path << std::endl;
+        return false;
+    }
+
+    // Generator truth lives in the Truth sidecar, one row per simulated
+    // event; older files carry it in PhotonCounts itself
+    auto* truth = input.truthEntry.empty() ? nullptr : dynamic_cast<TTree*>(file.Get("Truth"));
+    auto* truthTree = truth ? truth : tree;
+
+    // --- Bind only the branches the summary uses ---
+    tree->SetBranchStatus("*", false);
+    auto enable = [tree](const char* name) {
+        if (!tree->GetBranch(name)) return false;
+        tree->SetBranchStatus(name, true);
+        return true;
+    };
+    const bool sparse = enable("tile") && enable("count");
+    int dense[kNTiles] = {};
+    std::vector<int>* tiles  = nullptr;
+    std::vector<int>* values = nullptr;
+    if (sparse) {
+        tree->SetBranchAddress("tile",  &tiles);
+        tree->SetBranchAddress("count", &values);
+    } else {
+        for (int i = 0; i < kNTiles; ++i) {
+            const std::string name = "sensor_" + std::to_string(i);
+            if (!enable(name.c_str())) {
+                std::cerr << "Error: Branch " << name << " not found in " << path << std::endl;
+                return false;
+            }
+            tree->SetBranchAddress(name.c_str(), &dense[i]);
+        }
+    }
+
+    int weight = 1;
+    if (enable("weight")) tree->SetBranchAddress("weight", &weight);
+
+    double nuEnergy = 0., x = 0., y = 0., z = 0.;
+    if (truth) truth->SetBranchStatus("*", false);
+    auto enableTruth = [truthTree](const char* name) {
+        if (!truthTree->GetBranch(name)) return false;
+        truthTree->SetBranchStatus(name, true);
+        return true;
+    };
+    const bool hasTruth = enableTruth("nu_energy") && enableTruth("vertex_x")
+                       && enableTruth("vertex_y") && enableTruth("vertex_z");
+    if (hasTruth) {
+        truthTree->SetBranchAddress("nu_energy", &nuEnergy);
+        truthTree->SetBranchAddress("vertex_x",  &x);
+        truthTree->SetBranchAddress("vertex_y",  &y);
+        truthTree->SetBranchAddress("vertex_z",  &z);
+    }
+
+    // Prefetch the active baskets of this range in large sequential reads
+    tree->SetCacheSize(64 << 20);
+    tree->SetCacheEntryRange(chunk.first, chunk.last);
+    tree->AddBranchToCache("*", true);
+    tree->StopCacheLearningPhase();
+    if (truth) {
+        truth->SetCacheSize(16 << 20);
+        truth->SetCacheEntryRange(input.truthEntry[chunk.first],
+                                  input.truthEntry[chunk.last - 1] + 1);
+        truth->AddBranchToCache("*", true);
+        truth->StopCacheLearningPhase();
+    }
+
+    int counts[kNTiles];
+    for (Long64_t entry = chunk.first; entry < chunk.last; ++entry) {
+        tree->GetEntry(entry);
+        if (truth) truth->GetEntry(input.truthEntry[entry]);
+        if (sparse) {
+            std::fill(counts, counts + kNTiles, 0);
+            for (std::size_t k = 0; k < tiles->size(); ++k) {
+                const int tile = (*tiles)[k];
+                if (tile >= 0 && tile < kNTiles) counts[tile] = (*values)[k];
+            }
+        } else {
+            std::copy(dense, dense + kNTiles, counts);
+        }
+        acc.Fill(counts, weight, hasTruth, nuEnergy, x, y, z);
+    }
+    return true;
+}
+
+void PrintUsage()
+{
+    std::cerr << "Usage: ToyLArTPCSummary [options] <ToyLArTPC_t0.root> [more.root ...]\n"
+              << "\n"
+              << "Options:\n"
+              << "  -j <nThreads>        Worker threads (default: all cores)\n"
+              << "  -o <file>            Summary file (default ToyLArTPC_summary.root)\n"
+              << "  -chunk <entries>     Entries per work item (default 1000000)\n"
+              << "  -total-max <photons> Upper edge of the total-light spectrum (default 20000)\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    unsigned    nThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string output   = "ToyLArTPC_summary.root";
+    Long64_t    chunkEntries = 1000000;
+    double      totalMax = 20000.;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nThreads = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        } else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "-chunk" && i + 1 < argc) {
+            chunkEntries = std::max(1LL, std::stoll(argv[++i]));
+        } else if (arg == "-total-max" && i + 1 < argc) {
+            totalMax = std::stod(argv[++i]);
+        } else if (!arg.empty() && arg[0] == '-') {
+            PrintUsage();
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || totalMax <= 0.) {
+        PrintUsage();
+        return 1;
+    }
+
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(false);
+    const auto tStart = std::chrono::steady_clock::now();
+
+    // --- Split the files into entry ranges (file headers read in parallel) ---
+    std::vector<InputFile> inputs(files.size());
+    std::vector<char>      scanned(files.size(), 0);
+    RunTasks(files.size(), nThreads, [&](std::size_t f, unsigned) {
+        scanned[f] = ScanFile(files[f], inputs[f]);
+    });
+
+    std::vector<Chunk> chunks;
+    bool failed = false;
+    for (std::size_t f = 0; f < files.size(); ++f) {
+        if (!scanned[f]) {
+            failed = true;
+            continue;
+        }
+        const Long64_t entries = inputs[f].entries;
+        for (Long64_t first = 0; first < entries; first += chunkEntries) {
+            chunks.push_back({ f, first, std::min(first + chunkEntries, entries) });
+        }
+    }
+
+    // --- One accumulator per thread, merged at the end ---
+    std::vector<std::unique_ptr<SummaryAccumulator>> accumulators;
+    for (unsigned t = 0; t < nThreads; ++t) {
+        accumulators.push_back(std::make_unique<SummaryAccumulator>(
+            "_t" + std::to_string(t), totalMax));
+    }
+
+    std::atomic<bool> chunkFailed{false};
+    RunTasks(chunks.size(), nThreads, [&](std::size_t c, unsigned t) {
+        const auto f = chunks[c].file;
+        if (!ProcessChunk(files[f], inputs[f], chunks[c], *accumulators[t])) {
+            chunkFailed = true;
+        }
+    });
+
+    for (unsigned t = 1; t < nThreads; ++t) {
+        accumulators[0]->Merge(*accumulators[t]);
+    }
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - tStart;
+
+    std::cout << "Processed " << files.size() << " files in " << chunks.size()
+              << " chunks with " << nThreads << " threads, "
+              << wall.count() << " s" << std::endl;
+    if (!accumulators[0]->Write(output)) return 1;
+
+    return (failed || chunkFailed) ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+/// \file test_event_index.cc
+/// \brief Round trip of an event index written under an output directory.
+///
+/// Writes an index the way a run with `-output <dir>/run` does, reads it
+/// back from the same place and checks that every entry resolves to the
+/// segment file that holds it.
+
+#include "EventIndex.hh"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int gFailures = 0;
+
+void Check(bool condition, const std::string& what)
+{
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++gFailures;
+    }
+}
+
+} // anonymous namespace
+
+int main()
+{
+    namespace fs = std::filesystem;
+    const fs::path directory = "event_index_test/output";
+    fs::remove_all("event_index_test");
+    fs::create_directories(directory);
+
+    // Two worker segments, events interleaved between them
+    const std::string base = (directory / "run").string();
+    const std::string files[2] = { base + "_t0.root", base + "_t1.root" };
+    for (const auto& file : files) std::ofstream(file) << "segment";
+
+    std::vector<ToyLArTPC::EventIndexEntry> thread0, thread1;
+    for (std::int64_t event = 0; event < 10; ++event) {
+        ToyLArTPC::EventIndexEntry entry;
+        entry.event       = event;
+        entry.countsEntry = event / 2;
+        entry.truthEntry  = event / 2;
+        (event % 2 == 0 ? thread0 : thread1).push_back(entry);
+    }
+    ToyLArTPC::EventIndex::AddThread(files[0], thread0);
+    ToyLArTPC::EventIndex::AddThread(files[1], thread1);
+    Check(ToyLArTPC::EventIndex::Write(base + ".index") == 10, "ten entries written");
+
+    const ToyLArTPC::EventIndex index(base + ".index");
+    Check(index.GetNumberOfEntries() == 10, "ten entries read");
+    Check(index.GetFiles().size() == 2 && index.GetFiles()[0] == "run_t0.root",
+          "names stored relative to the index");
+    for (std::int64_t event = 0; event < 10; ++event) {
+        ToyLArTPC::EventIndexEntry entry;
+        if (!index.Find(event, entry)) {
+            Check(false, "event " + std::to_string(event) + " found");
+            continue;
+        }
+        const auto path = index.GetFilePath(entry.file);
+        Check(path == files[event % 2], "event " + std::to_string(event) + " in " + path);
+        Check(fs::exists(path), path + " exists");
+        Check(entry.countsEntry == event / 2, "entry of event " + std::to_string(event));
+    }
+    ToyLArTPC::EventIndexEntry missing;
+    Check(!index.Find(10, missing), "event 10 not found");
+
+    fs::remove_all("event_index_test");
+    if (gFailures == 0) std::cout << "EventIndex round trip: OK" << std::endl;
+    return gFailures == 0 ? 0 : 1;
+}
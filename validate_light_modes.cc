@@ -0,0 +1,456 @@
+/// \file validate_light_modes.cc
+/// \brief Fidelity-versus-speed validation of the accelerated light modes.
+///
+/// Usage:
+///   ./ValidateLightModes <events.root> [-sim <ToyLArTPC>] [-n <nEvents>]
+///                        [-t <nThreads>] [-seed <seed>] [-cache <dir>]
+///                        [-mode <name> <scale> "<options>"] [-strict]
+///
+/// Runs a fixed-seed reference sample with full optical tracking at the
+/// physical yield, then the same events in every alternative mode, and
+/// compares the mode (counts multiplied by its scale) with the reference:
+///
+///   per-tile mean       Welch t-test (Bonferroni-corrected over the tiles)
+///   per-tile variance   variance ratio F, tested through ln F
+///   total light         two-sample Kolmogorov-Smirnov test
+///   arrival times       chi-square test of the summed histogram shapes
+///
+/// and the wall-time speedup.  The reference is cached in the cache
+/// directory and reused while the event file, simulator, seed and event
+/// count are unchanged.  Without -mode, the default reduced yield (scale
+/// 24000/240 = 100) is validated.
+
+#include "DetectorParameters.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace DP = ToyLArTPC::DetectorParameters;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kNTiles = DP::kNTiles;
+constexpr int kNBins  = DP::kTimeBins;
+
+/// One light mode: simulator options and the factor that brings its photon
+/// counts to the full-yield scale.
+struct Mode {
+    std::string name;
+    double      scale;
+    std::string options;
+};
+
+/// Per-event photon counts of one sample, plus its summed arrival times.
+struct Sample {
+    std::vector<int>    counts;     ///< Event-major, kNTiles per event
+    std::vector<double> totals;     ///< Photons per event
+    std::vector<double> arrival = std::vector<double>(kNBins, 0.);
+    bool                hasArrival = false;
+
+    std::size_t Events() const { return totals.size(); }
+};
+
+/// Upper tail of the standard normal distribution.
+double NormalTail(double z)
+{
+    return 0.5 * std::erfc(z / std::sqrt(2.));
+}
+
+/// Upper tail of the chi-square distribution (Wilson-Hilferty
+/// approximation, good to a few per mille for ndf above 10).
+double ChiSquareTail(double chi2, int ndf)
+{
+    if (ndf <= 0) return 1.;
+    const double k = ndf;
+    const double z = (std::cbrt(chi2 / k) - (1. - 2. / (9. * k)))
+                   / std::sqrt(2. / (9. * k));
+    return NormalTail(z);
+}
+
+/// Kolmogorov distribution Q(lambda) = P(K > lambda).
+double KolmogorovTail(double lambda)
+{
+    if (lambda < 0.2) return 1.;
+    double sum = 0.;
+    for (int k = 1; k <= 100; ++k) {
+        const double term = std::exp(-2. * k * k * lambda * lambda);
+        sum += (k % 2 ? 2. : -2.) * term;
+        if (term < 1.e-12) break;
+    }
+    return std::clamp(sum, 0., 1.);
+}
+
+/// Two-sample Kolmogorov-Smirnov test; returns the p-value, D in `d`.
+double KolmogorovSmirnov(std::vector<double> a, std::vector<double> b, double& d)
+{
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    const double na = a.size(), nb = b.size();
+    std::size_t i = 0, j = 0;
+    d = 0.;
+    while (i < a.size() && j < b.size()) {
+        const double x = std::min(a[i], b[j]);
+        while (i < a.size() && a[i] <= x) ++i;
+        while (j < b.size() && b[j] <= x) ++j;
+        d = std::max(d, std::abs(i / na - j / nb));
+    }
+    const double n = std::sqrt(na * nb / (na + nb));
+    return KolmogorovTail((n + 0.12 + 0.11 / n) * d);
+}
+
+/// Chi-square comparison of two unweighted histograms with different
+/// totals (only their shapes are compared).  Returns the p-value.
+double HistogramChiSquare(const std::vector<double>& a, const std::vector<double>& b,
+                          double& chi2, int& ndf)
+{
+    double na = 0., nb = 0.;
+    for (int i = 0; i < kNBins; ++i) {
+        na += a[i];
+        nb += b[i];
+    }
+    chi2 = 0.;
+    ndf  = -1;
+    if (na <= 0. || nb <= 0.) return 0.;
+    for (int i = 0; i < kNBins; ++i) {
+        if (a[i] + b[i] <= 0.) continue;
+        const double diff = nb * a[i] - na * b[i];
+        chi2 += diff * diff / (a[i] + b[i]);
+        ++ndf;
+    }
+    chi2 /= na * nb;
+    return ChiSquareTail(chi2, ndf);
+}
+
+/// Output files of run `base`: <base>.root, or <base>_t<k>.root per worker.
+std::vector<std::string> OutputFiles(const fs::path& base)
+{
+    std::vector<std::string> files;
+    const std::regex pattern(base.filename().string() + "(_t[0-9]+)?\\.root");
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(base.parent_path(), error)) {
+        if (std::regex_match(entry.path().filename().string(), pattern)) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/// Read every row of `files`; counts are multiplied by `scale`.
+bool ReadSample(const std::vector<std::string>& files, double scale, Sample& sample)
+{
+    if (files.empty()) return false;
+    sample.hasArrival = true;
+
+    for (const auto& path : files) {
+        TFile file(path.c_str(), "READ");
+        auto* tree = file.IsZombie() ? nullptr : dynamic_cast<TTree*>(file.Get("PhotonCounts"));
+        if (!tree) {
+            std::cerr << "Error: No PhotonCounts tree in " << path << std::endl;
+            return false;
+        }
+
+        const bool sparse = tree->GetBranch("tile") && tree->GetBranch("count");
+        int dense[kNTiles] = {};
+        std::vector<int>* tiles  = nullptr;
+        std::vector<int>* values = nullptr;
+        if (sparse) {
+            tree->SetBranchAddress("tile",  &tiles);
+            tree->SetBranchAddress("count", &values);
+        } else {
+            for (int i = 0; i < kNTiles; ++i) {
+                const std::string name = "sensor_" + std::to_string(i);
+                if (!tree->GetBranch(name.c_str())) {
+                    std::cerr << "Error: Branch " << name << " not found in " << path << std::endl;
+                    return false;
+                }
+                tree->SetBranchAddress(name.c_str(), &dense[i]);
+            }
+        }
+        std::vector<int>* arrival = nullptr;
+        if (tree->GetBranch("arrival_time")) {
+            tree->SetBranchAddress("arrival_time", &arrival);
+        } else {
+            sample.hasArrival = false;
+        }
+
+        const Long64_t nEntries = tree->GetEntries();
+        for (Long64_t entry = 0; entry < nEntries; ++entry) {
+            tree->GetEntry(entry);
+            const std::size_t row = sample.counts.size();
+            sample.counts.resize(row + kNTiles, 0);
+            if (sparse) {
+                for (std::size_t k = 0; k < tiles->size(); ++k) {
+                    const int tile = (*tiles)[k];
+                    if (tile >= 0 && tile < kNTiles) sample.counts[row + tile] = (*values)[k];
+                }
+            } else {
+                std::copy(dense, dense + kNTiles, sample.counts.begin() + row);
+            }
+
+            double total = 0.;
+            for (int i = 0; i < kNTiles; ++i) total += sample.counts[row + i];
+            sample.totals.push_back(scale * total);
+
+            if (arrival) {
+                const int n = std::min<int>(kNBins, static_cast<int>(arrival->size()));
+                for (int i = 0; i < n; ++i) sample.arrival[i] += (*arrival)[i];
+            }
+        }
+    }
+    return true;
+}
+
+/// Per-tile mean and (unbiased) variance of `sample`, scaled.
+void TileMoments(const Sample& sample, double scale,
+                 std::vector<double>& mean, std::vector<double>& variance)
+{
+    const double n = sample.Events();
+    mean.assign(kNTiles, 0.);
+    variance.assign(kNTiles, 0.);
+    for (std::size_t e = 0; e < sample.Events(); ++e) {
+        for (int i = 0; i < kNTiles; ++i) mean[i] += sample.counts[e * kNTiles + i];
+    }
+    for (int i = 0; i < kNTiles; ++i) mean[i] /= n;
+    for (std::size_t e = 0; e < sample.Events(); ++e) {
+        for (int i = 0; i < kNTiles; ++i) {
+            const double d = sample.counts[e * kNTiles + i] - mean[i];
+            variance[i] += d * d;
+        }
+    }
+    for (int i = 0; i < kNTiles; ++i) {
+        mean[i]     *= scale;
+        variance[i]  = scale * scale * variance[i] / std::max(1., n - 1.);
+    }
+}
+
+/// Run the simulator; returns the wall time in seconds, or -1 on failure.
+double RunSimulation(const std::string& command, const fs::path& base)
+{
+    for (const auto& file : OutputFiles(base)) fs::remove(file);
+
+    std::cout << "Running: " << command << std::endl;
+    const auto tStart = std::chrono::steady_clock::now();
+    const int status = std::system(command.c_str());
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - tStart;
+    if (status != 0) {
+        std::cerr << "Error: simulation failed (status " << status << "), see "
+                  << base.string() << ".log" << std::endl;
+        return -1.;
+    }
+    return wall.count();
+}
+
+/// Everything the reference depends on, one line.
+std::string ReferenceKey(const std::string& events, const std::string& simulator,
+                         int nEvents, long seed)
+{
+    auto stamp = [](const std::string& path) {
+        std::error_code error;
+        const auto time = fs::last_write_time(path, error);
+        const auto size = fs::file_size(path, error);
+        return std::to_string(time.time_since_epoch().count()) + ":" + std::to_string(size);
+    };
+    std::ostringstream key;
+    key << "events=" << fs::absolute(events).string() << '@' << stamp(events)
+        << " simulator=" << fs::absolute(simulator).string() << '@' << stamp(simulator)
+        << " n=" << nEvents << " seed=" << seed;
+    return key.str();
+}
+
+const char* Verdict(bool pass) { return pass ? "PASS" : "FAIL"; }
+
+void PrintUsage()
+{
+    std::cerr << "Usage: ValidateLightModes <events.root> [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  -sim <path>     Simulator executable (default ./ToyLArTPC)\n"
+              << "  -n <nEvents>    Events per sample (default 200)\n"
+              << "  -t <nThreads>   Simulator threads (default 0 = auto)\n"
+              << "  -seed <seed>    Seed shared by all samples (default 12345)\n"
+              << "  -cache <dir>    Reference cache and outputs (default validation)\n"
+              << "  -mode <name> <scale> \"<options>\"  Validate the simulator options\n"
+              << "                  against the reference, counts multiplied by <scale>;\n"
+              << "                  repeatable (default: reduced-yield 100 \"\")\n"
+              << "  -alpha <a>      Significance level of every test (default 0.01)\n"
+              << "  -strict         Exit with status 2 when a test fails\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-') {
+        PrintUsage();
+        return 1;
+    }
+    const std::string events = argv[1];
+    std::string simulator = "./ToyLArTPC";
+    std::string cacheDir  = "validation";
+    int    nEvents  = 200;
+    int    nThreads = 0;
+    long   seed     = 12345;
+    double alpha    = 0.01;
+    bool   strict   = false;
+    std::vector<Mode> modes;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-sim" && i + 1 < argc) {
+            simulator = argv[++i];
+        } else if (arg == "-n" && i + 1 < argc) {
+            nEvents = std::stoi(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            nThreads = std::stoi(argv[++i]);
+        } else if (arg == "-seed" && i + 1 < argc) {
+            seed = std::stol(argv[++i]);
+        } else if (arg == "-cache" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "-mode" && i + 3 < argc) {
+            modes.push_back({ argv[i + 1], std::stod(argv[i + 2]), argv[i + 3] });
+            i += 3;
+        } else if (arg == "-alpha" && i + 1 < argc) {
+            alpha = std::stod(argv[++i]);
+        } else if (arg == "-strict") {
+            strict = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (nEvents < 2) {
+        PrintUsage();
+        return 1;
+    }
+    if (modes.empty()) {
+        modes.push_back({ "reduced-yield", DP::kFullYieldPerMeV / DP::kReducedYieldPerMeV, "" });
+    }
+
+    fs::create_directories(cacheDir);
+    auto command = [&](const fs::path& base, const std::string& options) {
+        std::ostringstream cmd;
+        cmd << '"' << simulator << "\" \"" << events << '"'
+            << " -n " << nEvents << " -t " << nThreads << " -seed " << seed
+            << " -arrival-times -output \"" << base.string() << '"'
+            << (options.empty() ? "" : " ") << options
+            << " > \"" << base.string() << ".log\" 2>&1";
+        return cmd.str();
+    };
+
+    // --- Reference: full tracking at the physical yield, cached ---
+    const fs::path    referenceBase = fs::path(cacheDir) / "reference";
+    const fs::path    keyFile       = fs::path(cacheDir) / "reference.key";
+    const std::string key = ReferenceKey(events, simulator, nEvents, seed);
+
+    double referenceWall = -1.;
+    {
+        std::ifstream in(keyFile);
+        std::string cachedKey;
+        double cachedWall = -1.;
+        if (std::getline(in, cachedKey) && in >> cachedWall
+            && cachedKey == key && !OutputFiles(referenceBase).empty()) {
+            referenceWall = cachedWall;
+            std::cout << "Using cached reference in " << cacheDir << std::endl;
+        }
+    }
+    if (referenceWall < 0.) {
+        referenceWall = RunSimulation(command(referenceBase, "-full-yield"), referenceBase);
+        if (referenceWall < 0.) return 1;
+        std::ofstream(keyFile) << key << '\n' << referenceWall << '\n';
+    }
+
+    Sample reference;
+    if (!ReadSample(OutputFiles(referenceBase), 1., reference) || reference.Events() < 2) {
+        std::cerr << "Error: cannot read the reference sample" << std::endl;
+        return 1;
+    }
+    std::vector<double> refMean, refVariance;
+    TileMoments(reference, 1., refMean, refVariance);
+
+    // --- Every alternative mode against the reference ---
+    bool allPassed = true;
+    for (const auto& mode : modes) {
+        const fs::path base = fs::path(cacheDir) / mode.name;
+        const double   wall = RunSimulation(command(base, mode.options), base);
+        Sample sample;
+        if (wall < 0. || !ReadSample(OutputFiles(base), mode.scale, sample)
+            || sample.Events() < 2) {
+            std::cerr << "Error: mode " << mode.name << " produced no usable sample" << std::endl;
+            allPassed = false;
+            continue;
+        }
+
+        std::vector<double> mean, variance;
+        TileMoments(sample, mode.scale, mean, variance);
+
+        // Per tile: means (Welch) and variances (ln F is about normal with
+        // variance 2/(n1-1) + 2/(n2-1) for large samples)
+        const double n1 = reference.Events(), n2 = sample.Events();
+        const double tileAlpha = alpha / kNTiles;
+        int    meanFailures = 0, varianceFailures = 0, tested = 0;
+        double maxT = 0., minF = 0., maxF = 0.;
+        for (int i = 0; i < kNTiles; ++i) {
+            if (refVariance[i] <= 0. || variance[i] <= 0.) continue;
+            const double t = (mean[i] - refMean[i])
+                           / std::sqrt(refVariance[i] / n1 + variance[i] / n2);
+            const double f = variance[i] / refVariance[i];
+            const double z = std::log(f) / std::sqrt(2. / (n1 - 1.) + 2. / (n2 - 1.));
+            if (2. * NormalTail(std::abs(t)) < tileAlpha) ++meanFailures;
+            if (2. * NormalTail(std::abs(z)) < tileAlpha) ++varianceFailures;
+            maxT = std::max(maxT, std::abs(t));
+            minF = (tested == 0) ? f : std::min(minF, f);
+            maxF = (tested == 0) ? f : std::max(maxF, f);
+            ++tested;
+        }
+
+        double d = 0.;
+        const double ksP = KolmogorovSmirnov(reference.totals, sample.totals, d);
+
+        double chi2 = 0.;
+        int    ndf  = 0;
+        const bool   timing = reference.hasArrival && sample.hasArrival;
+        const double chi2P  = timing
+            ? HistogramChiSquare(reference.arrival, sample.arrival, chi2, ndf) : 1.;
+
+        const bool meanOK = meanFailures == 0, varianceOK = varianceFailures == 0;
+        const bool ksOK = ksP >= alpha, chi2OK = chi2P >= alpha;
+        allPassed = allPassed && meanOK && varianceOK && ksOK && chi2OK;
+
+        std::cout << std::setprecision(4)
+                  << "\n=== " << mode.name << " (x" << mode.scale << ") vs reference, "
+                  << n2 << "/" << n1 << " events ===\n"
+                  << "  per-tile mean      " << Verdict(meanOK) << "  " << meanFailures
+                  << "/" << tested << " tiles off, max |t| = " << maxT << '\n'
+                  << "  per-tile variance  " << Verdict(varianceOK) << "  " << varianceFailures
+                  << "/" << tested << " tiles off, F in [" << minF << ", " << maxF << "]\n"
+                  << "  total light (KS)   " << Verdict(ksOK) << "  D = " << d
+                  << ", p = " << ksP << '\n';
+        if (timing) {
+            std::cout << "  arrival times      " << Verdict(chi2OK) << "  chi2/ndf = "
+                      << chi2 << "/" << ndf << ", p = " << chi2P << '\n';
+        } else {
+            std::cout << "  arrival times      n/a   (no arrival_time column)\n";
+        }
+        std::cout << "  wall time          " << wall << " s (reference " << referenceWall
+                  << " s), speedup x" << referenceWall / wall << std::endl;
+    }
+
+    std::cout << "\nValidation " << (allPassed ? "passed" : "found differences")
+              << " at alpha = " << alpha << std::endl;
+    return (strict && !allPassed) ? 2 : 0;
+}